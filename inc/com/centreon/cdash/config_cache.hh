@@ -0,0 +1,67 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_CONFIG_CACHE_HH
+#  define CCC_CONFIG_CACHE_HH
+
+#  include <string>
+#  include <vector>
+#  include "com/centreon/cdash/object.hh"
+#  include "com/centreon/cdash/sequence.hh"
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  Cache of the resolved sequences of a set of configuration files.
+ *
+ *  The cache is a binary file, valid as long as the configuration files
+ *  and the files whose macros are resolved don't change.
+ */
+class             config_cache {
+  public:
+                  config_cache(std::vector<std::string> const& filenames);
+                  ~config_cache() noexcept;
+
+    bool          load(
+                    std::vector<std::vector<object>>& sequences,
+                    std::string& profile);
+    void          save(
+                    std::vector<sequence> const& sequences,
+                    std::string const& profile);
+    void          clear();
+    std::string const&
+                  get_path() const noexcept;
+
+  private:
+    std::vector<std::string>
+                  _filenames;
+    std::string   _path;
+    unsigned long long
+                  _key;
+
+    unsigned long long
+                  _get_key() const;
+    static std::string
+                  _get_directory();
+
+                  config_cache(config_cache const&) = delete;
+    config_cache& operator=(config_cache const&) = delete;
+};
+
+CCC_END()
+
+#endif // !CCC_CONFIG_CACHE_HH
@@ -0,0 +1,63 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_CONFIG_FILE_HH
+#  define CCC_CONFIG_FILE_HH
+
+#  include <string>
+#  include <vector>
+#  include "com/centreon/concurrency/runnable.hh"
+#  include "com/centreon/cdash/object.hh"
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  Parse a configuration file.
+ *
+ *  Runnable in a thread pool: configuration files don't reference each
+ *  other, so they are parsed concurrently.
+ */
+class             config_file : public concurrency::runnable {
+  public:
+                  config_file(std::string filename);
+                  ~config_file() noexcept;
+
+    void          run();
+
+    std::string const&
+                  get_filename() const noexcept;
+    std::vector<std::vector<object>>&
+                  get_sequences() noexcept;
+    std::string const&
+                  get_profile() const noexcept;
+    std::string const&
+                  get_error() const noexcept;
+
+  private:
+    std::string   _filename;
+    std::vector<std::vector<object>>
+                  _sequences;
+    std::string   _profile;
+    std::string   _error;
+
+                  config_file(config_file const&) = delete;
+    config_file&  operator=(config_file const&) = delete;
+};
+
+CCC_END()
+
+#endif // !CCC_CONFIG_FILE_HH
@@ -0,0 +1,52 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_DIGEST_HH
+#  define CCC_DIGEST_HH
+
+#  include <cstddef>
+#  include <string>
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  Non-cryptographic 64 bits digest of data (FNV-1a).
+ *
+ *  Used to detect changes in files, not to authenticate them.
+ */
+class             digest {
+  public:
+                  digest() noexcept;
+                  digest(digest const& other) noexcept;
+    digest&       operator=(digest const& other) noexcept;
+                  ~digest() noexcept;
+
+    void          update(void const* data, size_t size) noexcept;
+    void          update(std::string const& str) noexcept;
+    void          update_file(std::string const& filename);
+    unsigned long long
+                  get_value() const noexcept;
+    std::string   to_string() const;
+
+  private:
+    unsigned long long
+                  _value;
+};
+
+CCC_END()
+
+#endif // !CCC_DIGEST_HH
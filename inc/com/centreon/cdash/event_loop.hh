@@ -0,0 +1,52 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_EVENT_LOOP_HH
+#  define CCC_EVENT_LOOP_HH
+
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+class             event_loop {
+  public:
+                  event_loop();
+                  ~event_loop() noexcept;
+
+    // Events returned by wait(), as a bitmask.
+    enum          event {
+                  timer_expired = 1 << 0,
+                  notified = 1 << 1
+    };
+
+    void          notify() noexcept;
+    void          set_timer(unsigned int seconds);
+    unsigned int  wait();
+
+  private:
+    int           _epoll_fd;
+    int           _timer_fd;
+    int           _event_fd;
+
+    void          _close() noexcept;
+
+                  event_loop(event_loop const&) = delete;
+    event_loop&   operator=(event_loop const&) = delete;
+};
+
+CCC_END()
+
+#endif // !CCC_EVENT_LOOP_HH
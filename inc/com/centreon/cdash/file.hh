@@ -17,12 +17,24 @@
 #ifndef CCC_FILE_HH
 #  define CCC_FILE_HH
 
+#  include <memory>
 #  include <string>
+#  include "com/centreon/cdash/macro_template.hh"
 #  include "com/centreon/cdash/namespace.hh"
+#  include "com/centreon/cdash/resolved_content.hh"
 #  include "com/centreon/io/file_entry.hh"
 
 CCC_BEGIN()
 
+class                   object;
+
+/**
+ *  A file to copy to or from an instance.
+ *
+ *  The description of a file is immutable and shared by its copies:
+ *  copying a file only copies a pointer. Resolving its content gives
+ *  it a new description.
+ */
 class                   file {
   public:
                         file(
@@ -39,15 +51,31 @@ class                   file {
     std::string const&  get_local_filename() const noexcept;
     std::string const&  get_remote_filename() const noexcept;
     bool                resolve_macro() const noexcept;
-    std::string         get_file_content() const;
+    void                resolve_file_content(object const& obj);
+    void                write_content(
+                          object const& obj,
+                          macro_template::sink& out) const;
     void                set_resolved_file_content(std::string content);
     std::string const&  get_temporary_file() const noexcept;
 
   private:
-    std::string         _local_filename;
-    std::string         _remote_filename;
-    bool                _resolve_macro;
-    std::string         _temporary_file;
+    struct              description {
+      std::string       local_filename;
+      std::string       remote_filename;
+      bool              resolve_macro;
+      // Shared with the files having the same resolved content.
+      std::shared_ptr<resolved_content const>
+                        resolved;
+    };
+
+    std::shared_ptr<description const>
+                        _description;
+
+    void                _write_content(
+                          object const* obj,
+                          macro_template::sink& out) const;
+    void                _set_resolved_content(
+                          std::shared_ptr<resolved_content const> resolved);
 };
 
 CCC_END()
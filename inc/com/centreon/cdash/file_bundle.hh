@@ -0,0 +1,73 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_FILE_BUNDLE_HH
+#  define CCC_FILE_BUNDLE_HH
+
+#  include <string>
+#  include <vector>
+#  include "com/centreon/concurrency/thread.hh"
+#  include "com/centreon/process.hh"
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  Stream files as a tar archive into the standard input of a process,
+ *  from its own thread.
+ *
+ *  The process usually extracts the archive on a remote server. Once
+ *  all the files are written, the standard input of the process is
+ *  closed.
+ */
+class             file_bundle : public concurrency::thread {
+  public:
+                  file_bundle(process& proc);
+                  ~file_bundle() noexcept;
+
+    void          add_file(
+                    std::string local_filename,
+                    std::string content_filename,
+                    std::string remote_filename);
+    std::string const&
+                  get_error() const noexcept;
+    unsigned long long
+                  get_size() const noexcept;
+
+  protected:
+    void          _run();
+
+  private:
+    struct        entry {
+      std::string local_filename;
+      std::string content_filename;
+      std::string remote_filename;
+    };
+
+    process&      _proc;
+    std::vector<entry>
+                  _entries;
+    std::string   _error;
+    unsigned long long
+                  _size;
+
+                  file_bundle(file_bundle const&) = delete;
+    file_bundle&  operator=(file_bundle const&) = delete;
+};
+
+CCC_END()
+
+#endif // !CCC_FILE_BUNDLE_HH
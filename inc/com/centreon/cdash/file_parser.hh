@@ -20,7 +20,7 @@
 #  include <string>
 #  include "com/centreon/io/file_entry.hh"
 #  include "com/centreon/cdash/namespace.hh"
-#  include "com/centreon/cdash/xml/tree.hh"
+#  include "com/centreon/cdash/xml/reader.hh"
 
 CCC_BEGIN()
 
@@ -29,7 +29,7 @@ class           file_parser {
                 file_parser(std::string const& filename);
                 ~file_parser() noexcept;
 
-    xml::tree   parse() const;
+    xml::reader parse() const;
 
   private:
     io::file_entry
@@ -0,0 +1,82 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_FILE_STREAM_HH
+#  define CCC_FILE_STREAM_HH
+
+#  include <string>
+#  include "com/centreon/concurrency/thread.hh"
+#  include "com/centreon/process.hh"
+#  include "com/centreon/cdash/file.hh"
+#  include "com/centreon/cdash/macro_template.hh"
+#  include "com/centreon/cdash/namespace.hh"
+#  include "com/centreon/cdash/object.hh"
+
+CCC_BEGIN()
+
+/**
+ *  Stream the content of a file into the standard input of a process,
+ *  from its own thread.
+ *
+ *  The macros of the file are resolved just before the content is
+ *  written, and the resolved content released once written. The
+ *  process usually writes it to a remote file. The size of the content
+ *  is written first, on its own line. Once the content is written, the
+ *  standard input of the process is closed; on error, the process is
+ *  terminated.
+ */
+class             file_stream : public concurrency::thread,
+                                private macro_template::sink {
+  public:
+                  file_stream(
+                    process& proc,
+                    file const& fl,
+                    object const& obj);
+                  ~file_stream() noexcept;
+
+    file const&   get_file() const noexcept;
+    std::string const&
+                  get_error() const noexcept;
+    unsigned long long
+                  get_size() const noexcept;
+
+  protected:
+    void          _run();
+
+  private:
+    void          append(char const* data, size_t size);
+    void          flush();
+    void          _write(char const* data, size_t size);
+
+    process&      _proc;
+    file          _file;
+    object        _obj;
+    std::string   _buffer;
+    std::string   _error;
+    unsigned long long
+                  _size;
+
+    // Pieces are gathered up to this size before being written.
+    static const size_t
+                  _buffer_size = 64 * 1024;
+
+                  file_stream(file_stream const&) = delete;
+    file_stream&  operator=(file_stream const&) = delete;
+};
+
+CCC_END()
+
+#endif // !CCC_FILE_STREAM_HH
@@ -22,12 +22,16 @@
 #  include <map>
 #  include <memory>
 #  include <fstream>
+#  include "com/centreon/concurrency/mutex.hh"
 #  include "com/centreon/cdash/namespace.hh"
 
 CCC_BEGIN()
 
 namespace log {
 
+/**
+ *  Write the logs in their files. Can be used from several threads.
+ */
 class             engine {
 public:
   static void     log(
@@ -35,10 +39,11 @@ public:
                     std::string const& content);
 
 private:
-  static engine*  _p_engine;
   static constexpr char const*
                   _default_file_name = "cdash.log";
 
+  concurrency::mutex
+                  _mutex;
   std::map<std::string, std::unique_ptr<std::ofstream>>
                   _log_files;
 
@@ -47,6 +52,7 @@ private:
                   engine(engine const&) = delete;
  engine&          operator=(engine const&) = delete;
 
+ static engine&   _instance();
  void             _log(
                      std::string const& name,
                      std::string const& content);
@@ -0,0 +1,132 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_MACRO_SCOPE_HH
+#  define CCC_MACRO_SCOPE_HH
+
+#  include <map>
+#  include <memory>
+#  include <string>
+#  include <utility>
+#  include <vector>
+#  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/cdash/symbol_table.hh"
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  The macros of an object: its own macros, and the scopes of the
+ *  objects it inherits.
+ *
+ *  Inherited scopes are shared, not copied. A macro is looked up in the
+ *  own macros first, then in the inherited scopes from the last
+ *  inherited to the first. 'type.name' is also looked up as 'name' in
+ *  the inherited scopes of this type.
+ *
+ *  The content of a macro can use other macros. It is resolved on
+ *  demand in the scope defining the macro, and the result is kept
+ *  until this scope is modified. A macro using its own name uses the
+ *  macro of this name inherited by its scope.
+ */
+class             macro_scope {
+public:
+  // Macros, as (name, content) symbols sorted by name.
+  typedef std::vector<std::pair<symbol_table::symbol, symbol_table::symbol>>
+                  macro_list;
+  // The macros being resolved, as (scope, index of the macro).
+  typedef std::vector<std::pair<macro_scope const*, size_t>>
+                  resolution_stack;
+
+                  macro_scope(symbol_table::symbol type);
+                  macro_scope(macro_scope const& other);
+                  ~macro_scope() noexcept;
+
+  symbol_table::symbol
+                  get_type() const noexcept;
+  bool            find(
+                    symbol_table::symbol name,
+                    symbol_table::symbol& content) const noexcept;
+  bool            find(
+                    std::string const& name,
+                    symbol_table::symbol& content) const noexcept;
+  bool            resolve(
+                    symbol_table::symbol name,
+                    symbol_table::symbol& value) const;
+  bool            resolve(
+                    symbol_table::symbol name,
+                    symbol_table::symbol& value,
+                    resolution_stack& pending) const;
+  bool            resolve(
+                    std::string const& name,
+                    symbol_table::symbol& value) const;
+  void            set(
+                    symbol_table::symbol name,
+                    symbol_table::symbol content);
+  void            inherit(std::shared_ptr<macro_scope const> parent);
+  macro_list      flatten() const;
+
+private:
+  symbol_table::symbol
+                  _type;
+  macro_list      _macros;
+  std::vector<std::shared_ptr<macro_scope const>>
+                  _parents;
+  // The resolved contents of _macros, or not_found.
+  mutable std::vector<symbol_table::symbol>
+                  _resolved;
+  mutable concurrency::mutex
+                  _resolved_mutex;
+
+  bool            _find(
+                    symbol_table::symbol name,
+                    macro_scope const*& owner,
+                    size_t& index) const noexcept;
+  bool            _find(
+                    symbol_table::symbol name,
+                    bool qualified,
+                    symbol_table::symbol type,
+                    symbol_table::symbol unqualified,
+                    macro_scope const*& owner,
+                    size_t& index) const noexcept;
+  bool            _find_inherited(
+                    symbol_table::symbol name,
+                    macro_scope const*& owner,
+                    size_t& index) const noexcept;
+  bool            _find_inherited(
+                    symbol_table::symbol name,
+                    bool qualified,
+                    symbol_table::symbol type,
+                    symbol_table::symbol unqualified,
+                    macro_scope const*& owner,
+                    size_t& index) const noexcept;
+  bool            _find_not_interned(
+                    std::string const& name,
+                    macro_scope const*& owner,
+                    size_t& index) const noexcept;
+  symbol_table::symbol
+                  _resolve(size_t index, resolution_stack& pending) const;
+  void            _clear_resolved();
+  void            _flatten(
+                    std::map<symbol_table::symbol, symbol_table::symbol>&
+                      macros) const;
+
+  macro_scope&    operator=(macro_scope const& other) = delete;
+};
+
+CCC_END()
+
+#endif // !CCC_MACRO_SCOPE_HH
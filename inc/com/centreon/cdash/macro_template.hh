@@ -0,0 +1,93 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_MACRO_TEMPLATE_HH
+#  define CCC_MACRO_TEMPLATE_HH
+
+#  include <memory>
+#  include <string>
+#  include <unordered_map>
+#  include <vector>
+#  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/cdash/macro_scope.hh"
+#  include "com/centreon/cdash/symbol_table.hh"
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  A string with macros, parsed once.
+ *
+ *  '$name$' is replaced by the content of the macro 'name', '$$' by '$'.
+ */
+class             macro_template {
+public:
+  // Receive the pieces of an evaluation. They may be kept until the
+  // next flush.
+  class           sink {
+  public:
+    virtual       ~sink() noexcept {}
+    virtual void  append(char const* data, size_t size) = 0;
+    virtual void  flush() {}
+  };
+
+                  macro_template(std::string const& source);
+                  ~macro_template() noexcept;
+
+  static std::shared_ptr<macro_template const>
+                  compile(symbol_table::symbol source);
+  static std::string
+                  escape(std::string const& str);
+  std::string     evaluate(macro_scope const& scope) const;
+  std::string     evaluate(
+                    macro_scope const& scope,
+                    macro_scope::resolution_stack& pending) const;
+  static void     evaluate(
+                    char const* data,
+                    size_t size,
+                    macro_scope const& scope,
+                    sink& out);
+
+private:
+  // A literal, followed by a macro if 'macro' isn't not_found.
+  struct          segment {
+    std::string   literal;
+    symbol_table::symbol
+                  macro;
+  };
+
+  std::vector<segment>
+                  _segments;
+  size_t          _literal_size;
+
+  // The compiled templates, by symbol of their source.
+  struct          cache {
+    concurrency::mutex
+                  mut;
+    std::unordered_map<symbol_table::symbol,
+                       std::shared_ptr<macro_template const>>
+                  templates;
+  };
+
+  static cache&   _get_cache();
+
+                  macro_template(macro_template const&) = delete;
+  macro_template& operator=(macro_template const&) = delete;
+};
+
+CCC_END()
+
+#endif // !CCC_MACRO_TEMPLATE_HH
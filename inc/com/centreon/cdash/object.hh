@@ -17,16 +17,22 @@
 #ifndef CCC_OBJECT_HH
 #  define CCC_OBJECT_HH
 
+#  include <memory>
 #  include <string>
-#  include <map>
 #  include <vector>
 #  include "com/centreon/cdash/file.hh"
+#  include "com/centreon/cdash/macro_scope.hh"
+#  include "com/centreon/cdash/macro_template.hh"
+#  include "com/centreon/cdash/symbol_table.hh"
 #  include "com/centreon/cdash/namespace.hh"
 
 CCC_BEGIN()
 
 class             object {
   public:
+    typedef macro_scope::macro_list
+                  macro_list;
+
                   object(std::string type);
                   object(object const& obj);
     object&       operator=(object const& obj);
@@ -40,10 +46,22 @@ class             object {
     std::string const&
                   get_type() const noexcept;
     bool          macro_exists(std::string const& name) const noexcept;
-    std::string   macro_content(std::string const& name) const noexcept;
-    void          set_macro(std::string name, std::string content);
+    bool          macro_exists(symbol_table::symbol name) const noexcept;
+    std::string const&
+                  macro_content(std::string const& name) const;
+    std::string const&
+                  macro_content(symbol_table::symbol name) const;
+    void          set_macro(std::string const& name, std::string const& content);
+    void          set_macro(
+                    symbol_table::symbol name,
+                    symbol_table::symbol content);
+    macro_list    get_macros() const;
     void          inherit_macros(object const& obj);
     std::string   resolve_macros(std::string str) const;
+    void          resolve_macros(
+                    char const* data,
+                    size_t size,
+                    macro_template::sink& out) const;
 
     void          add_file(
                     std::string local_filename,
@@ -62,12 +80,16 @@ class             object {
   private:
     std::string  _name;
     std::string  _type;
-    std::map<std::string, std::string>
-                 _macros;
+    // Shared with the copies of this object and the objects inheriting
+    // it, copied before being modified.
+    std::shared_ptr<macro_scope>
+                 _scope;
     std::vector<file>
                  _files;
     std::vector<file>
                  _returned_files;
+
+    macro_scope& _get_scope_mut();
 };
 
 CCC_END()
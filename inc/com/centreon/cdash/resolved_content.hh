@@ -0,0 +1,112 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_RESOLVED_CONTENT_HH
+#  define CCC_RESOLVED_CONTENT_HH
+
+#  include <map>
+#  include <memory>
+#  include <string>
+#  include <sys/uio.h>
+#  include <utility>
+#  include <vector>
+#  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/cdash/digest.hh"
+#  include "com/centreon/cdash/macro_template.hh"
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  The resolved content of a file, stored once in a file.
+ *
+ *  Contents are addressed by their digest, and compared byte by byte
+ *  before being shared: files with the same resolved content share
+ *  it. The file is removed when the last reference to the content is
+ *  released.
+ */
+class             resolved_content {
+public:
+  // Write a content to store as it is produced, without building it
+  // in memory first.
+  class           writer : public macro_template::sink {
+  public:
+                  writer();
+                  ~writer() noexcept;
+
+    void          append(char const* data, size_t size);
+    void          flush();
+    std::shared_ptr<resolved_content const>
+                  commit();
+
+  private:
+    int           _fd;
+    unsigned int  _id;
+    std::string   _path;
+    digest        _digest;
+    size_t        _size;
+    // The pieces appended but not written yet.
+    std::vector<iovec>
+                  _pending;
+
+    void          _flush();
+
+                  writer(writer const&) = delete;
+    writer&       operator=(writer const&) = delete;
+  };
+
+                  ~resolved_content() noexcept;
+
+  static std::shared_ptr<resolved_content const>
+                  store(std::string const& content);
+  std::string const&
+                  get_path() const noexcept;
+  size_t          get_size() const noexcept;
+
+private:
+  // (digest, size) of a content.
+  typedef std::pair<unsigned long long, size_t>
+                  key;
+
+  // The contents stored, by key.
+  struct          registry {
+    concurrency::mutex
+                  mut;
+    std::string   directory;
+    unsigned int  next_id;
+    std::map<key, std::pair<resolved_content const*,
+                            std::weak_ptr<resolved_content const>>>
+                  contents;
+
+                  registry();
+                  ~registry() noexcept;
+  };
+
+  key             _key;
+  std::string     _path;
+
+                  resolved_content(key k, std::string path);
+                  resolved_content(resolved_content const&) = delete;
+  resolved_content&
+                  operator=(resolved_content const&) = delete;
+
+  static registry&
+                  _get_registry();
+};
+
+CCC_END()
+
+#endif // !CCC_RESOLVED_CONTENT_HH
@@ -35,13 +35,22 @@ class             sequence {
     bool          next_task();
     bool          ended() const noexcept;
     void          reset() noexcept;
+    void          checkpoint();
+    unsigned int  resume();
+    std::vector<unsigned int> const&
+                  get_completed_tasks() const noexcept;
 
     void          add_task(task tsk);
+    std::vector<task> const&
+                  get_tasks() const noexcept;
 
   private:
     std::vector<task>
                  _tasks;
     unsigned int _task_index;
+    // The indexes of the completed tasks.
+    std::vector<unsigned int>
+                 _completed_tasks;
 
                   sequence(sequence const&) = delete;
     sequence&     operator=(sequence const&) = delete;
@@ -0,0 +1,72 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_SPOT_REQUEST_HH
+#  define CCC_SPOT_REQUEST_HH
+
+#  include <string>
+#  include <vector>
+#  include "com/centreon/concurrency/runnable.hh"
+#  include "com/centreon/timestamp.hh"
+#  include "com/centreon/aws/ec2/launch_specification.hh"
+#  include "com/centreon/aws/ec2/spot_instance.hh"
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  Request several spot instances sharing the same launch specification.
+ *
+ *  Runnable in a thread pool, so that heterogeneous launch specifications
+ *  are requested concurrently.
+ */
+class             spot_request : public concurrency::runnable {
+  public:
+                  spot_request(
+                    std::string profile,
+                    aws::ec2::launch_specification spec,
+                    unsigned int count,
+                    double price,
+                    timestamp valid_until);
+                  ~spot_request() noexcept;
+
+    void          run();
+
+    unsigned int  get_count() const noexcept;
+    std::vector<aws::ec2::spot_instance> const&
+                  get_spot_instances() const noexcept;
+    std::string const&
+                  get_error() const noexcept;
+
+  private:
+    std::string   _profile;
+    aws::ec2::launch_specification
+                  _spec;
+    unsigned int  _count;
+    double        _price;
+    timestamp     _valid_until;
+
+    std::vector<aws::ec2::spot_instance>
+                  _spot_instances;
+    std::string   _error;
+
+                  spot_request(spot_request const&) = delete;
+    spot_request& operator=(spot_request const&) = delete;
+};
+
+CCC_END()
+
+#endif // !CCC_SPOT_REQUEST_HH
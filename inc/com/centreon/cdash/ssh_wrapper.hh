@@ -18,6 +18,7 @@
 #  define CCC_SSH_WRAPPER_HH
 
 #  include <string>
+#  include <vector>
 #  include "com/centreon/process.hh"
 #  include "com/centreon/cdash/namespace.hh"
 
@@ -33,6 +34,10 @@ class               ssh_wrapper {
     ssh_wrapper&    operator=(ssh_wrapper const&);
                     ~ssh_wrapper();
 
+    void            set_cipher(std::string const& cipher);
+    void            set_compression(bool compression);
+    void            close_master();
+
     void            copy_file(
                       process& proc,
                       std::string const& local_filename,
@@ -50,13 +55,53 @@ class               ssh_wrapper {
                       std::string const& command,
                       std::string const& identity_file_path,
                       unsigned int timeout);
+    void            create_archive(
+                      process& proc,
+                      std::vector<std::string> const& remote_filenames,
+                      std::string const& identity_file_path,
+                      unsigned int timeout);
+    void            extract_archive(
+                      process& proc,
+                      std::string const& identity_file_path,
+                      unsigned int timeout);
+    void            write_file(
+                      process& proc,
+                      std::string const& remote_filename,
+                      unsigned int mode,
+                      std::string const& identity_file_path,
+                      unsigned int timeout);
 
   private:
                     ssh_wrapper() = delete;
 
+    std::string     _get_command(
+                      std::string const& program,
+                      std::string const& port_option,
+                      std::string const& identity_file_path,
+                      unsigned int timeout) const;
+    static std::string const&
+                    _get_control_directory();
+    static std::string
+                    _create_control_directory();
+    static void     _exec(process& proc, std::string const& command);
+    static std::string
+                    _quote(std::string const& str);
+    static std::string
+                    _protect(std::string const& remote_cmd);
+
     std::string     _host;
     unsigned short  _port;
     std::string     _user;
+    std::string     _cipher;
+    bool            _compression;
+    // Socket of the master connection, empty if connections aren't shared.
+    std::string     _control_path;
+
+    // How long the master connection stays open once unused, in seconds.
+    static constexpr unsigned int
+                    _control_persist_duration = 5 * 60;
+    static constexpr unsigned int
+                    _close_master_timeout = 10;
 };
 
 CCC_END()
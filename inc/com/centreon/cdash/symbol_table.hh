@@ -0,0 +1,115 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_SYMBOL_TABLE_HH
+#  define CCC_SYMBOL_TABLE_HH
+
+#  include <atomic>
+#  include <cstddef>
+#  include <map>
+#  include <string>
+#  include <unordered_map>
+#  include <utility>
+#  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  Global pool of interned strings.
+ *
+ *  Each distinct string is stored once, and identified by a symbol.
+ *  Symbols are never freed. Getting the string of a symbol doesn't
+ *  lock the table.
+ */
+class             symbol_table {
+public:
+  typedef unsigned int
+                  symbol;
+  // Symbol of the empty string.
+  static constexpr symbol
+                  empty = 0;
+  // Returned by find() for strings never interned.
+  static constexpr symbol
+                  not_found = static_cast<symbol>(-1);
+
+  static symbol   intern(std::string const& str);
+  static symbol   intern(char const* data, size_t size);
+  static symbol   intern_qualified(symbol type, symbol name);
+  static symbol   find(std::string const& str) noexcept;
+  static symbol   find(char const* data, size_t size) noexcept;
+  static bool     split_qualified(
+                    symbol sym,
+                    symbol& type,
+                    symbol& name) noexcept;
+  static std::string const&
+                  get(symbol sym) noexcept;
+
+private:
+  // A string, not owned.
+  struct          key {
+    char const*   data;
+    size_t        size;
+  };
+  struct          key_hash {
+    size_t        operator()(key const& k) const noexcept;
+  };
+  struct          key_equal {
+    bool          operator()(key const& a, key const& b) const noexcept;
+  };
+
+  // Size of the first block of strings, doubled for each next block.
+  static constexpr size_t
+                  _first_block_size = 1024;
+  // Enough blocks for all the symbols.
+  static constexpr unsigned int
+                  _max_blocks = 23;
+
+  concurrency::mutex
+                  _mut;
+  // The keys point into the strings: strings can be looked up without
+  // being copied.
+  std::unordered_map<key, symbol, key_hash, key_equal>
+                  _symbols;
+  // The strings, by symbol. Blocks are only added, and never moved:
+  // the strings of the symbols already returned are read without the
+  // lock.
+  std::atomic<std::string*>
+                  _blocks[_max_blocks];
+  // The number of strings, under the lock.
+  symbol          _size;
+  // The symbols of the 'type.name' strings.
+  std::map<std::pair<symbol, symbol>, symbol>
+                  _qualified;
+  // The (type, name) symbols of the 'type.name' strings, (not_found,
+  // not_found) for strings without a dot.
+  std::map<symbol, std::pair<symbol, symbol>>
+                  _splits;
+
+                  symbol_table();
+                  ~symbol_table() noexcept;
+                  symbol_table(symbol_table const&) = delete;
+  symbol_table&   operator=(symbol_table const&) = delete;
+
+  static symbol_table&
+                  _instance();
+  std::string&    _at(symbol sym) const noexcept;
+  symbol          _intern(char const* data, size_t size);
+};
+
+CCC_END()
+
+#endif // !CCC_SYMBOL_TABLE_HH
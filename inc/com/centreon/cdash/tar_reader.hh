@@ -0,0 +1,82 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_TAR_READER_HH
+#  define CCC_TAR_READER_HH
+
+#  include <map>
+#  include <string>
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  Extract the expected files of a tar archive fed by chunks.
+ *
+ *  Each expected entry of the archive is written to its own local
+ *  filename. Other entries are skipped. Understands ustar, GNU long
+ *  names and pax path records.
+ */
+class             tar_reader {
+  public:
+                  tar_reader();
+                  ~tar_reader() noexcept;
+
+    void          add_file(
+                    std::string const& name,
+                    std::string const& local_filename);
+    void          feed(char const* data, size_t size);
+    void          finish();
+    std::map<std::string, unsigned long long> const&
+                  get_extracted_files() const noexcept;
+
+  private:
+    enum          state {
+                  header,
+                  content,
+                  long_name,
+                  pax_header,
+                  padding,
+                  end
+    };
+
+    std::map<std::string, std::string>
+                  _expected;
+    std::map<std::string, unsigned long long>
+                  _extracted;
+    state         _state;
+    std::string   _buffer;
+    unsigned long long
+                  _left;
+    unsigned long long
+                  _padding;
+    std::string   _next_name;
+    std::string   _current_name;
+    int           _fd;
+
+    void          _parse_header();
+    void          _parse_pax_header();
+    void          _open(std::string const& name, unsigned int mode);
+    void          _close() noexcept;
+    void          _start_content(state st, unsigned long long size);
+
+                  tar_reader(tar_reader const&) = delete;
+    tar_reader&   operator=(tar_reader const&) = delete;
+};
+
+CCC_END()
+
+#endif // !CCC_TAR_READER_HH
@@ -0,0 +1,62 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_TAR_WRITER_HH
+#  define CCC_TAR_WRITER_HH
+
+#  include <string>
+#  include "com/centreon/process.hh"
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  Write a tar (ustar) archive on the standard input of a process.
+ */
+class             tar_writer {
+  public:
+                  tar_writer(process& proc);
+                  ~tar_writer() noexcept;
+
+    void          add_file(
+                    std::string const& name,
+                    std::string const& local_filename,
+                    unsigned int mode);
+    void          finish();
+    unsigned long long
+                  get_size() const noexcept;
+
+  private:
+    process&      _proc;
+    unsigned long long
+                  _size;
+
+    void          _write_header(
+                    std::string const& name,
+                    char type,
+                    unsigned long long size,
+                    unsigned int mode,
+                    long mtime);
+    void          _write(void const* data, size_t size);
+    void          _pad(unsigned long long size);
+
+                  tar_writer(tar_writer const&) = delete;
+    tar_writer&   operator=(tar_writer const&) = delete;
+};
+
+CCC_END()
+
+#endif // !CCC_TAR_WRITER_HH
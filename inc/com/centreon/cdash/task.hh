@@ -18,6 +18,7 @@
 #  define CCC_TASK_HH
 
 #  include <string>
+#  include "com/centreon/aws/ec2/launch_specification.hh"
 #  include "com/centreon/cdash/object.hh"
 #  include "com/centreon/cdash/namespace.hh"
 
@@ -25,27 +26,46 @@ CCC_BEGIN()
 
 class             task {
   public:
-                  task(object obj);
+                  task(object obj, bool resolve_file_macros = true);
                   task(task&& tsk) noexcept;
     task&         operator=(task&& tsk) noexcept;
 
-    std::string   get_ami() const;
-    std::string   get_amazon_instance_type() const;
+    std::string const&
+                  get_ami() const;
+    std::string const&
+                  get_amazon_instance_type() const;
     std::vector<file> const&
                   get_files() const noexcept;
     std::vector<file> const&
                   get_returned_files() const noexcept;
-    std::string   get_command() const;
+    std::string const&
+                  get_command() const;
     std::string   get_name() const;
-    std::string   get_key_name() const;
-    std::string   get_security_group() const;
-    std::string   get_security_group_id() const;
-    std::string   get_key_file() const;
+    std::string const&
+                  get_key_name() const;
+    std::string const&
+                  get_security_group() const;
+    std::string const&
+                  get_security_group_id() const;
+    std::string const&
+                  get_key_file() const;
     unsigned int  get_ssh_timeout() const;
     std::string   get_ssh_user() const;
     unsigned short get_ssh_port() const;
+    std::string const&
+                  get_ssh_cipher() const;
+    bool          get_ssh_compression() const;
     bool          should_be_deleted() const noexcept;
-    std::string   get_subnet_id() const;
+    bool          is_resumable() const noexcept;
+    unsigned int  get_instance_linger_time() const;
+    unsigned int  get_slots() const;
+    std::string   get_file_transport() const;
+    std::string const&
+                  get_subnet_id() const;
+    aws::ec2::launch_specification
+                  get_launch_specification() const;
+    std::string   get_launch_specification_key() const;
+    object const& get_object() const noexcept;
 
   private:
     object        _obj;
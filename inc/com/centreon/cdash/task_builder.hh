@@ -0,0 +1,59 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_TASK_BUILDER_HH
+#  define CCC_TASK_BUILDER_HH
+
+#  include <memory>
+#  include <string>
+#  include "com/centreon/concurrency/runnable.hh"
+#  include "com/centreon/cdash/object.hh"
+#  include "com/centreon/cdash/task.hh"
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+/**
+ *  Create a task from its object.
+ *
+ *  Runnable in a thread pool, so that the macros of the tasks and of
+ *  their files are resolved concurrently.
+ */
+class             task_builder : public concurrency::runnable {
+  public:
+                  task_builder(object obj, bool resolve_file_macros);
+                  ~task_builder() noexcept;
+
+    void          run();
+
+    task&         get_task() noexcept;
+    std::string const&
+                  get_error() const noexcept;
+
+  private:
+    object        _obj;
+    bool          _resolve_file_macros;
+    std::unique_ptr<task>
+                  _task;
+    std::string   _error;
+
+                  task_builder(task_builder const&) = delete;
+    task_builder& operator=(task_builder const&) = delete;
+};
+
+CCC_END()
+
+#endif // !CCC_TASK_BUILDER_HH
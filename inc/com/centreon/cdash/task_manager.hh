@@ -21,6 +21,7 @@
 #  include <vector>
 #  include <map>
 #  include <string>
+#  include "com/centreon/cdash/event_loop.hh"
 #  include "com/centreon/cdash/task.hh"
 #  include "com/centreon/cdash/sequence.hh"
 #  include "com/centreon/cdash/namespace.hh"
@@ -42,6 +43,7 @@ class             task_manager {
     // Used to manage signal termination.
     static volatile bool
                   should_exit;
+    static void   wake_up() noexcept;
 
   private:
     std::string   _profile;
@@ -49,19 +51,61 @@ class             task_manager {
     static const unsigned int
                   _validity_time_duration = 3600 * 24;
     static const unsigned int
-                  _polling_duration = 15;
+                  _fast_polling_duration = 5;
+    static const unsigned int
+                  _slow_polling_duration = 60;
     static constexpr double
                   _price = 0.3;
+    static const unsigned int
+                  _describe_chunk_size = 200;
+    static const unsigned int
+                  _max_concurrent_requests = 8;
+
+    event_loop    _loop;
+    static event_loop* volatile
+                  _running_loop;
 
     std::vector<aws::ec2::spot_instance>
                   _spot_instances;
-    std::map<std::string, std::unique_ptr<task_process>>
+    // Task processes by spot request id. An instance with several slots
+    // runs several task processes.
+    typedef std::multimap<std::string, std::unique_ptr<task_process>>
+                  task_process_map;
+    task_process_map
                   _task_processes;
 
+    // Instances whose sequence is finished, kept running for a while
+    // for sequences with the same launch specification.
+    struct        idle_instance {
+      aws::ec2::spot_instance
+                  spot_instance;
+      aws::ec2::instance
+                  instance;
+      timestamp   idle_until;
+      bool        should_delete;
+      unsigned int
+                  slots;
+    };
+    std::multimap<std::string, idle_instance>
+                  _idle_instances;
+
     void          _reap_finished_tasks();
     void          _create_spot_instances(
                     std::vector<sequence>& sequences);
     void          _poll_spot_instances();
+    unsigned int  _get_polling_duration();
+    void          _release_instance(task_process& tp);
+    void          _bind_idle_instances();
+    unsigned int  _bind_waiting_task_processes(
+                    std::string const& key,
+                    aws::ec2::spot_instance const& spi,
+                    aws::ec2::instance const& ins,
+                    unsigned int slots,
+                    bool should_delete);
+    void          _expire_idle_instances(bool all) noexcept;
+    void          _cancel_spot_instances(
+                    std::vector<aws::ec2::spot_instance> const& spis)
+                    noexcept;
 
                   task_manager() = delete;
                   task_manager(task_manager const&) = delete;
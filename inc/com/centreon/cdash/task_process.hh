@@ -17,8 +17,15 @@
 #ifndef CCC_TASK_PROCESS_HH
 #  define CCC_TASK_PROCESS_HH
 
+#  include <map>
+#  include <memory>
 #  include <string>
+#  include <vector>
 #  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/cdash/event_loop.hh"
+#  include "com/centreon/cdash/file_bundle.hh"
+#  include "com/centreon/cdash/file_stream.hh"
+#  include "com/centreon/cdash/tar_reader.hh"
 #  include "com/centreon/cdash/task.hh"
 #  include "com/centreon/cdash/sequence.hh"
 #  include "com/centreon/aws/ec2/instance.hh"
@@ -27,6 +34,7 @@
 #  include "com/centreon/cdash/ssh_wrapper.hh"
 #  include "com/centreon/process.hh"
 #  include "com/centreon/process_listener.hh"
+#  include "com/centreon/timestamp.hh"
 
 CCC_BEGIN()
 
@@ -35,18 +43,30 @@ class             task_process : public process_listener {
                   task_process(
                     std::string profile,
                     sequence seq,
-                    aws::ec2::spot_instance const& spot_instance);
+                    aws::ec2::spot_instance const& spot_instance,
+                    event_loop& loop);
                   ~task_process() noexcept;
 
     aws::ec2::spot_instance const&
                   get_spot_instance() const noexcept;
     aws::ec2::instance const&
                   get_instance() const noexcept;
+    std::string const&
+                  get_launch_specification_key() const noexcept;
+    unsigned int  get_instance_linger_time() const noexcept;
+    unsigned int  get_slots() const noexcept;
+    bool          should_delete_instance() const noexcept;
 
     void          visit(aws::ec2::spot_instance const& spot_instance);
     void          visit(aws::ec2::instance const& instance);
     bool          is_finished();
+    bool          is_waiting_for_instance();
     bool          is_in_fatal_error();
+    void          release_instance();
+    void          adopt_instance(
+                    aws::ec2::spot_instance const& spot_instance,
+                    aws::ec2::instance const& instance,
+                    bool should_delete);
 
     virtual void  data_is_available(process& p) noexcept;
     virtual void  data_is_available_err(process& p) noexcept;
@@ -57,11 +77,19 @@ class             task_process : public process_listener {
                   _mut;
 
     std::string   _profile;
+    event_loop&   _loop;
     sequence      _sequence;
-    aws::ec2::spot_instance const*
+    aws::ec2::spot_instance
                   _spot_instance;
     aws::ec2::instance
                   _instance;
+    bool          _owns_instance;
+    bool          _should_delete;
+    std::string   _launch_specification_key;
+    unsigned int  _linger_time;
+    unsigned int  _slots;
+    // Remote working directory, used when the instance is shared.
+    std::string   _working_directory;
 
     std::vector<file>
                    _files_to_copy;
@@ -70,15 +98,18 @@ class             task_process : public process_listener {
     std::string    _command;
 
     std::string   _out;
-    std::string   _err_out;
+    // The error output of each process, as transfers run concurrently.
+    std::map<process*, std::string>
+                  _err_out;
 
     // The state of this state machine.
     // When everything is okay, it goes like this:
-    // waiting_for_spot_instance -> waiting_for_instance -> (copying_files -> running -> copying_files_back) * tasks -> ended
+    // waiting_for_spot_instance -> waiting_for_instance -> [creating_working_directory] -> (copying_files -> running -> copying_files_back) * tasks -> ended
     // Unrepairable errors are signaled by the 'error' state.
     enum          state {
                   waiting_for_spot_instance,
                   waiting_for_instance,
+                  creating_working_directory,
                   copying_files,
                   running,
                   copying_files_back,
@@ -87,15 +118,49 @@ class             task_process : public process_listener {
     };
     state         _state;
 
-    //ssh_wrapper   _ssh;
+    // Last ssh wrapper used, to close its master connection.
+    std::unique_ptr<ssh_wrapper>
+                  _ssh;
     process       _process;
 
+    // Processes used to upload files concurrently, and the files
+    // they are uploading.
+    static const unsigned int
+                  _max_concurrent_transfers = 4;
+    std::vector<std::unique_ptr<process>>
+                  _transfers;
+    std::map<process*, file>
+                  _transfers_in_flight;
+    // Files streamed by the transfer processes, resolved on the fly.
+    std::map<process*, std::unique_ptr<file_stream>>
+                  _streams;
+    // Files streamed in one tar archive.
+    std::unique_ptr<file_bundle>
+                  _bundle;
+    // Returned files received in one tar archive.
+    std::unique_ptr<tar_reader>
+                  _archive;
+    std::string   _archive_error;
+    timestamp     _archive_start;
+
     void          _clear();
     void          _run();
     void          _start_next_task();
+    void          _start_transfers();
+    void          _start_bundle();
+    void          _wait_for_bundle();
+    void          _start_archive();
+    void          _finish_archive();
+    void          _start_transfer(process& p);
+    void          _transfer_finished(process& p);
+    bool          _wait_for_stream(process& p);
+    void          _terminate_processes();
     void          _terminate_associated_instance();
+    void          _cancel_spot_request();
     std::string const&
                   _get_ip() const noexcept;
+    ssh_wrapper   _get_ssh_wrapper();
+    std::string   _get_remote_filename(file const& fl) const;
 
                   task_process() = delete;
                   task_process(task_process const&) = delete;
@@ -0,0 +1,34 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_VERSION_HH
+#  define CCC_VERSION_HH
+
+#  include "com/centreon/cdash/namespace.hh"
+
+CCC_BEGIN()
+
+namespace            version {
+  // Compile-time values.
+  unsigned int const major = 1;
+  unsigned int const minor = 0;
+  unsigned int const patch = 0;
+  char const* const  string = "1.0.0";
+}
+
+CCC_END()
+
+#endif // !CCC_VERSION_HH
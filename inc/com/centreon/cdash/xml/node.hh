@@ -46,7 +46,10 @@ public:
   };
   type          get_type() const noexcept;
   std::string   get_name() const;
+  char const*   get_name_data() const noexcept;
+  bool          has_name(char const* name) const noexcept;
   std::string   get_content() const;
+  char const*   get_content_data(std::string& buffer) const;
   node          get_child(std::string const& name) const noexcept;
   std::vector<node>
                 get_children(std::string const& name) const noexcept;
@@ -0,0 +1,69 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_XML_NODE_INDEX_HH
+#  define CCC_XML_NODE_INDEX_HH
+
+#  include <cstring>
+#  include <unordered_map>
+#  include <vector>
+#  include "com/centreon/cdash/namespace.hh"
+#  include "com/centreon/cdash/xml/node.hh"
+
+CCC_BEGIN()
+
+namespace xml {
+
+/**
+ *  The element children of a node, indexed by name.
+ *
+ *  The index is built once, in one pass over the children. Names
+ *  aren't copied: they point into the document, which must outlive
+ *  the index.
+ */
+class           node_index {
+public:
+                node_index(node const& nd);
+                ~node_index() noexcept;
+
+  node const&   get_node() const noexcept;
+  node          get_child(char const* name) const noexcept;
+  std::vector<node> const&
+                get_children(char const* name) const noexcept;
+
+private:
+  struct        name_hash {
+    size_t      operator()(char const* name) const noexcept;
+  };
+  struct        name_equal {
+    bool        operator()(char const* a, char const* b) const noexcept {
+      return (::strcmp(a, b) == 0);
+    }
+  };
+
+  node          _node;
+  std::unordered_map<char const*, std::vector<node>, name_hash, name_equal>
+                _children;
+
+                node_index(node_index const&) = delete;
+  node_index&   operator=(node_index const&) = delete;
+};
+
+} //namespace xml
+
+CCC_END()
+
+#endif // !CCC_XML_NODE_INDEX_HH
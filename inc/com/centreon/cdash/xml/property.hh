@@ -32,6 +32,7 @@ public:
 
   std::string   get_name() const;
   std::string   get_content() const;
+  char const*   get_content_data(std::string& buffer) const;
 
 private:
   xmlAttrPtr    _prop;
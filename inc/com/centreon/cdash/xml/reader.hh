@@ -0,0 +1,60 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CCC_XML_READER_HH
+#  define CCC_XML_READER_HH
+
+#  include <string>
+#  include <libxml/xmlreader.h>
+#  include "com/centreon/cdash/namespace.hh"
+#  include "com/centreon/cdash/xml/node.hh"
+
+CCC_BEGIN()
+
+namespace xml {
+
+/**
+ *  Read the children of the root node of a document, one at a time.
+ *
+ *  Only the current child is held in memory: it is freed when reading
+ *  the next one.
+ */
+class           reader {
+public:
+                reader(std::string const& filename);
+                ~reader() noexcept;
+                reader(reader&& rd);
+  reader&       operator=(reader&& rd);
+
+  bool          null() const noexcept;
+  node          next();
+
+private:
+                reader(reader const& rd) = delete;
+  reader&       operator=(reader const& rd) = delete;
+
+  xmlTextReaderPtr
+                _reader;
+  std::string   _filename;
+  bool          _root_found;
+  bool          _on_child;
+};
+
+} //namespace xml
+
+CCC_END()
+
+#endif // !CCC_XML_READER_HH
@@ -20,7 +20,8 @@
 #  include <map>
 #  include <vector>
 #  include <string>
-#  include "com/centreon/cdash/xml/tree.hh"
+#  include "com/centreon/cdash/xml/node_index.hh"
+#  include "com/centreon/cdash/xml/reader.hh"
 #  include "com/centreon/cdash/object.hh"
 #  include "com/centreon/cdash/namespace.hh"
 
@@ -28,28 +29,26 @@ CCC_BEGIN()
 
 class                   xml_tree_parser {
   public:
-                        xml_tree_parser(xml::tree tree);
+                        xml_tree_parser(xml::reader reader);
                         ~xml_tree_parser() noexcept;
 
   void                  parse(
                           std::vector<std::vector<object>>& sequences,
-                          std::string& profile) const;
+                          std::string& profile);
 
   private:
-    xml::tree           _tree;
+    xml::reader         _reader;
 
-    std::string         _parse_node(
-                          xml::node node,
-                          std::vector<object> const& use,
+    object*             _parse_node(
+                          xml::node_index const& node,
+                          std::vector<object const*> const& use,
                           std::map<std::string, object> &objects) const;
     void                _for_each_node(
-                          std::vector<std::vector<object>>::const_iterator here,
-                          std::vector<std::vector<object>>::const_iterator end,
-                          std::vector<object> const& sequential_entries,
-                          xml::node node,
-                          std::vector<object>& use,
+                          std::vector<std::vector<object const*>> const& for_each_entries,
+                          std::vector<object const*> const& sequential_entries,
+                          xml::node_index const& node,
                           std::map<std::string, object> &objects,
-                          std::vector<std::vector<std::string>>& sequence_list) const;
+                          std::vector<std::vector<object*>>& sequence_list) const;
 
                         xml_tree_parser(xml_tree_parser const&) = delete;
     xml_tree_parser&    operator=(xml_tree_parser const&) = delete;
@@ -28,6 +28,20 @@ args_parser::args_parser() {
   help.set_long_name("help");
   help.set_name('h');
   _arguments['h'] = help;
+
+  misc::argument no_config_cache;
+  no_config_cache.set_description(
+    "don't use the cache of the resolved configuration");
+  no_config_cache.set_long_name("no-config-cache");
+  no_config_cache.set_name('n');
+  _arguments['n'] = no_config_cache;
+
+  misc::argument clear_config_cache;
+  clear_config_cache.set_description(
+    "remove the cache of the resolved configuration before using it");
+  clear_config_cache.set_long_name("clear-config-cache");
+  clear_config_cache.set_name('c');
+  _arguments['c'] = clear_config_cache;
 }
 
 /**
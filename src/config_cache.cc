@@ -0,0 +1,468 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "com/centreon/cdash/config_cache.hh"
+#include "com/centreon/cdash/digest.hh"
+#include "com/centreon/cdash/log/log.hh"
+#include "com/centreon/cdash/log/error.hh"
+#include "com/centreon/cdash/macro_template.hh"
+#include "com/centreon/cdash/symbol_table.hh"
+#include "com/centreon/exceptions/basic.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+// Change it when the format of the cache changes.
+static char const cache_magic[8] = { 'C', 'D', 'A', 'S', 'H', 'C', 'C', '3' };
+
+// How the macros of a file are resolved. A resolved file is followed
+// by its resolved content.
+static unsigned long long const file_not_resolved = 0;
+static unsigned long long const file_resolved = 1;
+static unsigned long long const file_resolved_when_sent = 2;
+
+/**
+ *  Append a number to a cache buffer.
+ *
+ *  @param[out] buffer  The buffer.
+ *  @param[in]  value   The number.
+ */
+static void write_number(std::string& buffer, unsigned long long value) {
+  buffer.append(reinterpret_cast<char const*>(&value), sizeof(value));
+}
+
+/**
+ *  Append a string to a cache buffer.
+ *
+ *  @param[out] buffer  The buffer.
+ *  @param[in]  str     The string.
+ */
+static void write_string(std::string& buffer, std::string const& str) {
+  write_number(buffer, str.size());
+  buffer.append(str);
+}
+
+/**
+ *  Read a number from a cache buffer.
+ *
+ *  @param[in,out] ptr  The position in the buffer.
+ *  @param[in]     end  The end of the buffer.
+ *
+ *  @return  The number.
+ */
+static unsigned long long read_number(char const*& ptr, char const* end) {
+  unsigned long long value;
+  if (static_cast<size_t>(end - ptr) < sizeof(value))
+    throw (exceptions::basic() << "config_cache: truncated cache");
+  ::memcpy(&value, ptr, sizeof(value));
+  ptr += sizeof(value);
+  return (value);
+}
+
+/**
+ *  Read a string from a cache buffer.
+ *
+ *  @param[in,out] ptr  The position in the buffer.
+ *  @param[in]     end  The end of the buffer.
+ *
+ *  @return  The string.
+ */
+static std::string read_string(char const*& ptr, char const* end) {
+  unsigned long long size = read_number(ptr, end);
+  if (static_cast<unsigned long long>(end - ptr) < size)
+    throw (exceptions::basic() << "config_cache: truncated cache");
+  std::string str(ptr, size);
+  ptr += size;
+  return (str);
+}
+
+/**
+ *  Read a whole file.
+ *
+ *  @param[in] filename  The file.
+ *
+ *  @return  The content of the file.
+ */
+static std::string read_file(std::string const& filename) {
+  std::string content;
+  int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    char const* error = ::strerror(errno);
+    throw (exceptions::basic()
+           << "config_cache: couldn't open '" << filename << "': " << error);
+  }
+  char buffer[64 * 1024];
+  ssize_t rb;
+  while ((rb = ::read(fd, buffer, sizeof(buffer))) != 0) {
+    if (rb < 0 && errno == EINTR)
+      continue ;
+    if (rb < 0) {
+      char const* error = ::strerror(errno);
+      ::close(fd);
+      throw (exceptions::basic()
+             << "config_cache: couldn't read '" << filename << "': " << error);
+    }
+    content.append(buffer, rb);
+  }
+  ::close(fd);
+  return (content);
+}
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] filenames  The configuration files.
+ */
+config_cache::config_cache(std::vector<std::string> const& filenames)
+  : _filenames(filenames),
+    _key(0) {
+  std::string directory = _get_directory();
+  if (directory.empty())
+    return ;
+
+  // One cache for each set of configuration files.
+  digest name;
+  for (auto const& filename : _filenames) {
+    char resolved[PATH_MAX];
+    name.update(::realpath(filename.c_str(), resolved) ? resolved : filename);
+  }
+  _path = directory + "/" + name.to_string() + ".cache";
+}
+
+/**
+ *  Destructor.
+ */
+config_cache::~config_cache() noexcept {}
+
+/**
+ *  Load the resolved sequences from the cache, if it is valid.
+ *
+ *  The content of the files whose macros are resolved is loaded too:
+ *  tasks don't need to resolve them again.
+ *
+ *  @param[out] sequences  The objects of the sequences.
+ *  @param[out] profile    The profile.
+ *
+ *  @return  True if the cache was valid and loaded.
+ */
+bool config_cache::load(
+                     std::vector<std::vector<object>>& sequences,
+                     std::string& profile) {
+  if (_path.empty())
+    return (false);
+
+  // The key is computed before parsing, so that files modified in the
+  // meantime invalidate the saved cache.
+  try {
+    _key = _get_key();
+  } catch (std::exception const& e) {
+    // The parsing of the configuration will report the error.
+    _path.clear();
+    return (false);
+  }
+
+  int fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1)
+    return (false);
+  struct stat st;
+  void* mapping = MAP_FAILED;
+  if (::fstat(fd, &st) == 0 && st.st_size > 0)
+    mapping = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED)
+    return (false);
+
+  bool loaded = false;
+  try {
+    char const* ptr = static_cast<char const*>(mapping);
+    char const* end = ptr + st.st_size;
+    if (static_cast<size_t>(end - ptr) < sizeof(cache_magic)
+        || ::memcmp(ptr, cache_magic, sizeof(cache_magic)) != 0)
+      throw (exceptions::basic() << "config_cache: invalid cache");
+    ptr += sizeof(cache_magic);
+
+    // Check that nothing changed.
+    bool valid = (read_number(ptr, end) == _key);
+    for (unsigned long long count = read_number(ptr, end);
+         valid && count > 0;
+         --count) {
+      std::string filename = read_string(ptr, end);
+      unsigned long long value = read_number(ptr, end);
+      digest dig;
+      try {
+        dig.update_file(filename);
+      } catch (std::exception const& e) {
+        valid = false;
+      }
+      valid = valid && (dig.get_value() == value);
+    }
+
+    if (valid) {
+      std::vector<std::vector<object>> loaded_sequences;
+      std::string loaded_profile = read_string(ptr, end);
+      for (unsigned long long seq_count = read_number(ptr, end);
+           seq_count > 0;
+           --seq_count) {
+        std::vector<object> objects;
+        for (unsigned long long obj_count = read_number(ptr, end);
+             obj_count > 0;
+             --obj_count) {
+          std::string name = read_string(ptr, end);
+          object obj(read_string(ptr, end));
+          obj.set_name(std::move(name));
+          for (unsigned long long macro_count = read_number(ptr, end);
+               macro_count > 0;
+               --macro_count) {
+            std::string macro_name = read_string(ptr, end);
+            obj.set_macro(
+                  macro_name,
+                  macro_template::escape(read_string(ptr, end)));
+          }
+          for (unsigned long long file_count = read_number(ptr, end);
+               file_count > 0;
+               --file_count) {
+            std::string local_filename = read_string(ptr, end);
+            std::string remote_filename = read_string(ptr, end);
+            unsigned long long resolution = read_number(ptr, end);
+            obj.add_file(
+                  std::move(local_filename),
+                  std::move(remote_filename),
+                  resolution != file_not_resolved);
+            if (resolution == file_resolved)
+              obj.get_files_mut().back().set_resolved_file_content(
+                                           read_string(ptr, end));
+          }
+          for (unsigned long long file_count = read_number(ptr, end);
+               file_count > 0;
+               --file_count) {
+            std::string local_filename = read_string(ptr, end);
+            obj.add_returned_file(
+                  std::move(local_filename),
+                  read_string(ptr, end));
+          }
+          objects.push_back(std::move(obj));
+        }
+        loaded_sequences.push_back(std::move(objects));
+      }
+      for (auto& seq : loaded_sequences)
+        sequences.push_back(std::move(seq));
+      profile = std::move(loaded_profile);
+      loaded = true;
+      LOG()
+        << "configuration loaded from cache '" << _path << "'";
+    }
+    else
+      LOG()
+        << "configuration cache '" << _path << "' is outdated";
+  } catch (std::exception const& e) {
+    ERROR()
+      << "couldn't load configuration cache '" << _path << "': "
+      << e.what();
+  }
+  ::munmap(mapping, st.st_size);
+  return (loaded);
+}
+
+/**
+ *  Save the resolved sequences in the cache.
+ *
+ *  Must be called after load().
+ *
+ *  @param[in] sequences  The sequences, with their files resolved.
+ *  @param[in] profile    The profile.
+ */
+void config_cache::save(
+                     std::vector<sequence> const& sequences,
+                     std::string const& profile) {
+  if (_path.empty())
+    return ;
+
+  try {
+    std::string buffer;
+    buffer.append(cache_magic, sizeof(cache_magic));
+    write_number(buffer, _key);
+
+    // The files whose resolved content is cached.
+    std::map<std::string, unsigned long long> referenced;
+    for (auto const& seq : sequences)
+      for (auto const& tsk : seq.get_tasks())
+        for (auto const& fl : tsk.get_files())
+          if (!fl.get_temporary_file().empty()
+              && referenced.find(fl.get_local_filename())
+                   == referenced.end()) {
+            digest dig;
+            dig.update_file(fl.get_local_filename());
+            referenced[fl.get_local_filename()] = dig.get_value();
+          }
+    write_number(buffer, referenced.size());
+    for (auto const& ref : referenced) {
+      write_string(buffer, ref.first);
+      write_number(buffer, ref.second);
+    }
+
+    write_string(buffer, profile);
+    write_number(buffer, sequences.size());
+    for (auto const& seq : sequences) {
+      write_number(buffer, seq.get_tasks().size());
+      for (auto const& tsk : seq.get_tasks()) {
+        object const& obj = tsk.get_object();
+        write_string(buffer, obj.get_name());
+        write_string(buffer, obj.get_type());
+        object::macro_list macros = obj.get_macros();
+        write_number(buffer, macros.size());
+        for (auto const& macro : macros) {
+          write_string(buffer, symbol_table::get(macro.first));
+          write_string(buffer, symbol_table::get(macro.second));
+        }
+        write_number(buffer, obj.get_files().size());
+        for (auto const& fl : obj.get_files()) {
+          write_string(buffer, fl.get_local_filename());
+          write_string(buffer, fl.get_remote_filename());
+          if (!fl.resolve_macro())
+            write_number(buffer, file_not_resolved);
+          else if (fl.get_temporary_file().empty())
+            write_number(buffer, file_resolved_when_sent);
+          else {
+            write_number(buffer, file_resolved);
+            write_string(buffer, read_file(fl.get_temporary_file()));
+          }
+        }
+        write_number(buffer, obj.get_returned_files().size());
+        for (auto const& fl : obj.get_returned_files()) {
+          write_string(buffer, fl.get_local_filename());
+          write_string(buffer, fl.get_remote_filename());
+        }
+      }
+    }
+
+    // Replace the cache atomically.
+    std::string tmp_path = _path + "." + std::to_string(::getpid());
+    int fd = ::open(
+                 tmp_path.c_str(),
+                 O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                 0600);
+    if (fd == -1) {
+      char const* error = ::strerror(errno);
+      throw (exceptions::basic()
+             << "config_cache: couldn't create '" << tmp_path << "': "
+             << error);
+    }
+    char const* ptr = buffer.data();
+    size_t size = buffer.size();
+    while (size > 0) {
+      ssize_t wb = ::write(fd, ptr, size);
+      if (wb < 0 && errno == EINTR)
+        continue ;
+      if (wb < 0) {
+        char const* error = ::strerror(errno);
+        ::close(fd);
+        ::remove(tmp_path.c_str());
+        throw (exceptions::basic()
+               << "config_cache: couldn't write '" << tmp_path << "': "
+               << error);
+      }
+      ptr += wb;
+      size -= wb;
+    }
+    ::close(fd);
+    if (::rename(tmp_path.c_str(), _path.c_str()) != 0) {
+      char const* error = ::strerror(errno);
+      ::remove(tmp_path.c_str());
+      throw (exceptions::basic()
+             << "config_cache: couldn't rename '" << tmp_path << "': "
+             << error);
+    }
+    LOG()
+      << "configuration saved in cache '" << _path << "'";
+  } catch (std::exception const& e) {
+    ERROR()
+      << "couldn't save configuration cache '" << _path << "': "
+      << e.what();
+  }
+}
+
+/**
+ *  Remove the cache.
+ */
+void config_cache::clear() {
+  if (!_path.empty() && ::remove(_path.c_str()) == 0)
+    LOG()
+      << "configuration cache '" << _path << "' removed";
+}
+
+/**
+ *  Get the path of the cache.
+ *
+ *  @return  The path of the cache, or an empty string if there is no cache.
+ */
+std::string const& config_cache::get_path() const noexcept {
+  return (_path);
+}
+
+/**
+ *  Get the key of the configuration files: the cache is valid only for
+ *  this key.
+ *
+ *  @return  The key.
+ */
+unsigned long long config_cache::_get_key() const {
+  digest dig;
+  for (auto const& filename : _filenames) {
+    dig.update(filename);
+    dig.update_file(filename);
+  }
+  return (dig.get_value());
+}
+
+/**
+ *  Get the directory of the caches, creating it if needed.
+ *
+ *  It is $XDG_CACHE_HOME/cdash, or ~/.cache/cdash.
+ *
+ *  @return  The directory, or an empty string if it is unusable.
+ */
+std::string config_cache::_get_directory() {
+  std::string directory;
+  char const* cache_home = ::getenv("XDG_CACHE_HOME");
+  char const* home = ::getenv("HOME");
+  if (cache_home && *cache_home)
+    directory = cache_home;
+  else if (home && *home) {
+    directory = std::string(home) + "/.cache";
+    ::mkdir(directory.c_str(), 0700);
+  }
+  else
+    return (std::string());
+  directory.append("/cdash");
+  if (::mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+    char const* error = ::strerror(errno);
+    ERROR()
+      << "couldn't create configuration cache directory '" << directory
+      << "': " << error;
+    return (std::string());
+  }
+  return (directory);
+}
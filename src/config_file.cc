@@ -0,0 +1,90 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <utility>
+#include "com/centreon/cdash/config_file.hh"
+#include "com/centreon/cdash/file_parser.hh"
+#include "com/centreon/cdash/xml_tree_parser.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] filename  The configuration file.
+ */
+config_file::config_file(std::string filename)
+  : _filename(std::move(filename)) {
+  set_auto_delete(false);
+}
+
+/**
+ *  Destructor.
+ */
+config_file::~config_file() noexcept {}
+
+/**
+ *  Parse the configuration file.
+ *
+ *  Errors are stored instead of thrown, they are reported
+ *  by the owner of the file.
+ */
+void config_file::run() {
+  try {
+    file_parser fp(_filename);
+    xml_tree_parser xtp(fp.parse());
+    xtp.parse(_sequences, _profile);
+  } catch (std::exception const& e) {
+    _error = e.what();
+  }
+}
+
+/**
+ *  Get the name of the configuration file.
+ *
+ *  @return  The name of the file.
+ */
+std::string const& config_file::get_filename() const noexcept {
+  return (_filename);
+}
+
+/**
+ *  Get the sequences of task objects of the file.
+ *
+ *  @return  The sequences, to be moved by the caller.
+ */
+std::vector<std::vector<object>>& config_file::get_sequences() noexcept {
+  return (_sequences);
+}
+
+/**
+ *  Get the profile of the file.
+ *
+ *  @return  The profile, or an empty string if the file has none.
+ */
+std::string const& config_file::get_profile() const noexcept {
+  return (_profile);
+}
+
+/**
+ *  Get the error of the parsing.
+ *
+ *  @return  The error, or an empty string if the parsing succeeded.
+ */
+std::string const& config_file::get_error() const noexcept {
+  return (_error);
+}
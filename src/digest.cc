@@ -0,0 +1,137 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "com/centreon/cdash/digest.hh"
+#include "com/centreon/exceptions/basic.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+// FNV-1a parameters, for 64 bits.
+static unsigned long long const fnv_offset_basis = 14695981039346656037ULL;
+static unsigned long long const fnv_prime = 1099511628211ULL;
+
+/**
+ *  Constructor.
+ */
+digest::digest() noexcept
+  : _value(fnv_offset_basis) {}
+
+/**
+ *  Copy constructor.
+ *
+ *  @param[in] other  The object to copy.
+ */
+digest::digest(digest const& other) noexcept
+  : _value(other._value) {}
+
+/**
+ *  Assignment operator.
+ *
+ *  @param[in] other  The object to copy.
+ *
+ *  @return           A reference to this object.
+ */
+digest& digest::operator=(digest const& other) noexcept {
+  _value = other._value;
+  return (*this);
+}
+
+/**
+ *  Destructor.
+ */
+digest::~digest() noexcept {}
+
+/**
+ *  Add data to the digest.
+ *
+ *  @param[in] data  The data.
+ *  @param[in] size  The size of the data.
+ */
+void digest::update(void const* data, size_t size) noexcept {
+  unsigned char const* ptr = static_cast<unsigned char const*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    _value ^= ptr[i];
+    _value *= fnv_prime;
+  }
+}
+
+/**
+ *  Add a string to the digest.
+ *
+ *  The size of the string is added first, so that consecutive strings
+ *  can't be confused with their concatenation.
+ *
+ *  @param[in] str  The string.
+ */
+void digest::update(std::string const& str) noexcept {
+  unsigned long long size = str.size();
+  update(&size, sizeof(size));
+  update(str.data(), str.size());
+}
+
+/**
+ *  Add the content of a file to the digest.
+ *
+ *  @param[in] filename  The file.
+ */
+void digest::update_file(std::string const& filename) {
+  int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    char const* error = ::strerror(errno);
+    throw (exceptions::basic()
+           << "digest: couldn't open '" << filename << "': " << error);
+  }
+  char buffer[64 * 1024];
+  ssize_t rb;
+  while ((rb = ::read(fd, buffer, sizeof(buffer))) != 0) {
+    if (rb < 0 && errno == EINTR)
+      continue ;
+    if (rb < 0) {
+      char const* error = ::strerror(errno);
+      ::close(fd);
+      throw (exceptions::basic()
+             << "digest: couldn't read '" << filename << "': " << error);
+    }
+    update(buffer, rb);
+  }
+  ::close(fd);
+}
+
+/**
+ *  Get the value of the digest.
+ *
+ *  @return  The value.
+ */
+unsigned long long digest::get_value() const noexcept {
+  return (_value);
+}
+
+/**
+ *  Get the value of the digest as an hexadecimal string.
+ *
+ *  @return  The value, in hexadecimal.
+ */
+std::string digest::to_string() const {
+  char buffer[17];
+  ::snprintf(buffer, sizeof(buffer), "%016llx", _value);
+  return (buffer);
+}
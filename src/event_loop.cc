@@ -0,0 +1,148 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include "com/centreon/cdash/event_loop.hh"
+#include "com/centreon/exceptions/basic.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+/**
+ *  Constructor.
+ */
+event_loop::event_loop()
+  : _epoll_fd(-1),
+    _timer_fd(-1),
+    _event_fd(-1) {
+  _epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+  _timer_fd = ::timerfd_create(
+                  CLOCK_MONOTONIC,
+                  TFD_NONBLOCK | TFD_CLOEXEC);
+  _event_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (_epoll_fd == -1 || _timer_fd == -1 || _event_fd == -1) {
+    char const* error = ::strerror(errno);
+    _close();
+    throw (exceptions::basic()
+           << "event_loop: couldn't create the event loop: " << error);
+  }
+
+  epoll_event ev;
+  ::memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.u32 = timer_expired;
+  if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _timer_fd, &ev) == -1) {
+    char const* error = ::strerror(errno);
+    _close();
+    throw (exceptions::basic()
+           << "event_loop: couldn't watch the timer: " << error);
+  }
+  ev.data.u32 = notified;
+  if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _event_fd, &ev) == -1) {
+    char const* error = ::strerror(errno);
+    _close();
+    throw (exceptions::basic()
+           << "event_loop: couldn't watch the notifications: " << error);
+  }
+}
+
+/**
+ *  Destructor.
+ */
+event_loop::~event_loop() noexcept {
+  _close();
+}
+
+/**
+ *  Wake up the event loop.
+ *
+ *  Only calls write(2): safe from any thread and from a signal handler.
+ */
+void event_loop::notify() noexcept {
+  uint64_t one = 1;
+  int saved_errno = errno;
+  // If the counter is saturated, the loop is already awake.
+  if (::write(_event_fd, &one, sizeof(one)) == -1) {}
+  errno = saved_errno;
+}
+
+/**
+ *  Arm the timer. It expires once, after the given duration.
+ *
+ *  @param[in] seconds  Duration before the timer expires.
+ */
+void event_loop::set_timer(unsigned int seconds) {
+  itimerspec spec;
+  ::memset(&spec, 0, sizeof(spec));
+  spec.it_value.tv_sec = seconds;
+  // A zero it_value disarms the timer: expire as soon as possible instead.
+  if (seconds == 0)
+    spec.it_value.tv_nsec = 1;
+  if (::timerfd_settime(_timer_fd, 0, &spec, nullptr) == -1) {
+    char const* error = ::strerror(errno);
+    throw (exceptions::basic()
+           << "event_loop: couldn't arm the timer: " << error);
+  }
+}
+
+/**
+ *  Wait for the timer to expire or for a notification.
+ *
+ *  @return  A bitmask of the events that occured, or 0 if the wait
+ *           was interrupted by a signal.
+ */
+unsigned int event_loop::wait() {
+  epoll_event evs[2];
+  int count = ::epoll_wait(_epoll_fd, evs, 2, -1);
+  if (count == -1) {
+    if (errno == EINTR)
+      return (0);
+    char const* error = ::strerror(errno);
+    throw (exceptions::basic()
+           << "event_loop: couldn't wait for events: " << error);
+  }
+
+  unsigned int events = 0;
+  for (int i = 0; i < count; ++i) {
+    // Drain the descriptor, its content is irrelevant.
+    uint64_t value;
+    int fd = (evs[i].data.u32 == timer_expired) ? _timer_fd : _event_fd;
+    if (::read(fd, &value, sizeof(value)) == sizeof(value))
+      events |= evs[i].data.u32;
+  }
+  return (events);
+}
+
+/**
+ *  Close all the descriptors.
+ */
+void event_loop::_close() noexcept {
+  if (_event_fd != -1)
+    ::close(_event_fd);
+  if (_timer_fd != -1)
+    ::close(_timer_fd);
+  if (_epoll_fd != -1)
+    ::close(_epoll_fd);
+  _event_fd = -1;
+  _timer_fd = -1;
+  _epoll_fd = -1;
+}
@@ -14,20 +14,21 @@
 ** limitations under the License.
 */
 
-#include <cstdio>
+#include <cerrno>
 #include <cstring>
-#include <sstream>
-#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "com/centreon/exceptions/basic.hh"
 #include "com/centreon/cdash/file.hh"
+#include "com/centreon/cdash/object.hh"
 #include "com/centreon/io/file_entry.hh"
 #include "com/centreon/cdash/log/log.hh"
 
 using namespace com::centreon;
 using namespace com::centreon::cdash;
 
-static char const* tmp_file_template = "/tmp/resolved_macro_fileXXXXXX";
-
 /**
  *  Default constructor.
  *
@@ -38,10 +39,12 @@ static char const* tmp_file_template = "/tmp/resolved_macro_fileXXXXXX";
 file::file(
   std::string local_filename,
   std::string remote_filename,
-  bool resolve_macro)
-  : _local_filename(std::move(local_filename)),
-    _remote_filename(std::move(remote_filename)),
-    _resolve_macro(resolve_macro) {
+  bool resolve_macro) {
+  std::shared_ptr<description> desc(new description);
+  desc->local_filename = std::move(local_filename);
+  desc->remote_filename = std::move(remote_filename);
+  desc->resolve_macro = resolve_macro;
+  _description = std::move(desc);
   // Check the we can access this file.
   io::file_entry _(local_filename);
 }
@@ -49,49 +52,40 @@ file::file(
 /**
  *  Default constructor.
  */
-file::file() :
-        _resolve_macro(false) {
+file::file() {
+  std::shared_ptr<description> desc(new description);
+  desc->resolve_macro = false;
+  _description = std::move(desc);
 }
 
 /**
- *  Copy constructor.
+ *  Copy constructor. The description is shared.
  *
  *  @param[in] other  The object to copy.
  */
 file::file(file const& other)
-  : _local_filename(other._local_filename),
-    _remote_filename(other._remote_filename),
-    _resolve_macro(other._resolve_macro),
-    _temporary_file(other._temporary_file) {
+  : _description(other._description) {
 }
 
 /**
- *  Move constructor.
+ *  Move constructor. The description is shared, so that the moved
+ *  object stays usable.
  *
  *  @param[in] other  The object to move.
  */
 file::file(file&& other) noexcept
-  : _local_filename(other._local_filename),
-    _remote_filename(other._remote_filename),
-    _resolve_macro(other._resolve_macro),
-    _temporary_file(other._temporary_file) {
-
+  : _description(other._description) {
 }
 
 /**
- *  Assignment operator.
+ *  Assignment operator. The description is shared.
  *
  *  @param[in] other  The object to copy.
  *
  *  @return           Reference to this.
  */
 file& file::operator=(file const& other) {
-  if (this != &other) {
-    _local_filename = other._local_filename;
-    _remote_filename = other._remote_filename;
-    _resolve_macro = other._resolve_macro;
-    _temporary_file = other._temporary_file;
-  }
+  _description = other._description;
   return (*this);
 }
 
@@ -103,12 +97,7 @@ file& file::operator=(file const& other) {
  *  @return           Reference to this.
  */
 file& file::operator=(file&& other) noexcept {
-  if (this != &other) {
-    _local_filename = std::move(other._local_filename);
-    _remote_filename = std::move(other._remote_filename);
-    _resolve_macro = other._resolve_macro;
-    _temporary_file = std::move(other._temporary_file);
-  }
+  _description = other._description;
   return (*this);
 }
 
@@ -116,8 +105,6 @@ file& file::operator=(file&& other) noexcept {
  *  Destructor.
  */
 file::~file() noexcept {
-  if (!_temporary_file.empty())
-    std::remove(_temporary_file.c_str());
 }
 
 /**
@@ -126,7 +113,7 @@ file::~file() noexcept {
  *  @return  The local filename.
  */
 std::string const& file::get_local_filename() const  noexcept {
-  return (_local_filename);
+  return (_description->local_filename);
 }
 
 /**
@@ -135,7 +122,7 @@ std::string const& file::get_local_filename() const  noexcept {
  *  @return  The remote filename.
  */
 std::string const& file::get_remote_filename() const noexcept {
-  return (_remote_filename);
+  return (_description->remote_filename);
 }
 
 /**
@@ -144,70 +131,58 @@ std::string const& file::get_remote_filename() const noexcept {
  *  @return  True or false.
  */
 bool file::resolve_macro() const noexcept {
-  return (_resolve_macro);
+  return (_description->resolve_macro);
 }
 
 /**
- *  Get the content of a file.
+ *  Resolve the macros of the content of the file.
  *
- *  @return  The content of the file.
+ *  The resolved content is written as it is produced: nothing is
+ *  copied in memory.
+ *
+ *  @param[in] obj  The object whose macros are used.
  */
-std::string file::get_file_content() const {
-  std::ifstream ifs;
-  std::stringstream ss;
+void file::resolve_file_content(object const& obj) {
+  resolved_content::writer writer;
+  _write_content(&obj, writer);
+  _set_resolved_content(writer.commit());
 
-  try {
-  ifs.exceptions(~std::ofstream::goodbit);
-  ifs.open(_local_filename);
-  ss << ifs.rdbuf();
-  } catch (std::exception const& e) {
-    throw (exceptions::basic()
-           << "couldn't access the file '" << _local_filename << "'");
-  }
+  LOG()
+    << "resolving content of file '"
+    << _description->local_filename << "' into '"
+    << _description->resolved->get_path() << "'";
+}
 
-  return (std::move(ss.str()));
+/**
+ *  Write the content of the file, with its macros resolved if needed.
+ *
+ *  The content is produced from the local file as it is written,
+ *  without any temporary file.
+ *
+ *  @param[in] obj  The object whose macros are used.
+ *  @param[out] out The sink receiving the content.
+ */
+void file::write_content(
+             object const& obj,
+             macro_template::sink& out) const {
+  _write_content(_description->resolve_macro ? &obj : nullptr, out);
 }
 
 /**
- *  @brief Set a resolved file content to be put into a temporary file.
+ *  Set the resolved content of the file.
  *
+ *  It is stored in a file shared with the files having the same
+ *  resolved content.
+ *
+ *  @param[in] content  The resolved content.
  */
 void file::set_resolved_file_content(std::string content) {
-  // Create temporary file
-  std::vector<char> buf;
-  buf.resize(strlen(tmp_file_template) + 1);
-  ::strcpy(buf.data(), tmp_file_template);
-  int fd = ::mkstemp(buf.data());
-  if (fd == -1) {
-    char const* error = ::strerror(errno);
-    throw (exceptions::basic()
-           << "can't create temporary file for '"
-           << _local_filename << "': " << error);
-  }
-
-  _temporary_file = buf.data();
+  _set_resolved_content(resolved_content::store(content));
 
   LOG()
     << "resolving content of file '"
-    << _local_filename << "' into '"
-    << _temporary_file << "'";
-
-  // Copy content to temporary
-  std::ofstream ofs;
-  std::stringstream ss;
-
-  try {
-  ofs.exceptions(~std::ifstream::goodbit);
-  ofs.open(_temporary_file);
-
-  ss << content;
-  ofs << ss.rdbuf();
-  ofs.flush();
-  } catch (std::exception const& e) {
-    throw (exceptions::basic()
-           << "couldn't create the temporary file '"
-           << _temporary_file << "'");
-  }
+    << _description->local_filename << "' into '"
+    << _description->resolved->get_path() << "'";
 }
 
 /**
@@ -217,5 +192,79 @@ void file::set_resolved_file_content(std::string content) {
  *           if it exists.
  */
 std::string const& file::get_temporary_file() const noexcept {
-  return (_temporary_file);
+  static std::string const none;
+  return (_description->resolved ? _description->resolved->get_path() : none);
+}
+
+/**
+ *  Give a resolved content to the file.
+ *
+ *  The description is copied, as it is shared with the copies of this
+ *  file.
+ *
+ *  @param[in] resolved  The resolved content.
+ */
+void file::_set_resolved_content(
+             std::shared_ptr<resolved_content const> resolved) {
+  std::shared_ptr<description> desc(new description(*_description));
+  desc->resolved = std::move(resolved);
+  _description = std::move(desc);
+}
+
+/**
+ *  Write the content of the file.
+ *
+ *  The file is mapped and written as is, or with its macros resolved.
+ *
+ *  @param[in] obj  The object whose macros are used, or null to write
+ *                  the content as is.
+ *  @param[out] out The sink receiving the content.
+ */
+void file::_write_content(
+             object const* obj,
+             macro_template::sink& out) const {
+  std::string const& local_filename = _description->local_filename;
+  int fd = ::open(local_filename.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat st;
+  if (fd == -1 || ::fstat(fd, &st) != 0) {
+    char const* error = ::strerror(errno);
+    if (fd != -1)
+      ::close(fd);
+    throw (exceptions::basic()
+           << "couldn't access the file '" << local_filename
+           << "': " << error);
+  }
+  size_t size = st.st_size;
+  void* mapping = nullptr;
+  if (size > 0) {
+    mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      char const* error = ::strerror(errno);
+      ::close(fd);
+      throw (exceptions::basic()
+             << "couldn't map the file '" << local_filename
+             << "': " << error);
+    }
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+  }
+  ::close(fd);
+
+  try {
+    char const* data = mapping ? static_cast<char const*>(mapping) : "";
+    if (obj)
+      obj->resolve_macros(data, size, out);
+    else if (size > 0)
+      out.append(data, size);
+    // The content must not be used once unmapped.
+    out.flush();
+  } catch (std::exception const& e) {
+    if (mapping)
+      ::munmap(mapping, size);
+    throw (exceptions::basic()
+           << (obj ? "couldn't resolve the macros of the file '"
+                   : "couldn't write the file '")
+           << local_filename << "': " << e.what());
+  }
+  if (mapping)
+    ::munmap(mapping, size);
 }
@@ -0,0 +1,101 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <sys/stat.h>
+#include "com/centreon/cdash/file_bundle.hh"
+#include "com/centreon/cdash/tar_writer.hh"
+#include "com/centreon/exceptions/basic.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] proc  The process receiving the archive.
+ */
+file_bundle::file_bundle(process& proc)
+  : _proc(proc),
+    _size(0) {}
+
+/**
+ *  Destructor.
+ */
+file_bundle::~file_bundle() noexcept {}
+
+/**
+ *  Add a file to the bundle.
+ *
+ *  @param[in] local_filename    The local file, whose permissions are kept.
+ *  @param[in] content_filename  The file holding the content to send,
+ *                               i.e. the local file or its resolved copy.
+ *  @param[in] remote_filename   The remote filename.
+ */
+void file_bundle::add_file(
+                    std::string local_filename,
+                    std::string content_filename,
+                    std::string remote_filename) {
+  entry e;
+  e.local_filename = std::move(local_filename);
+  e.content_filename = std::move(content_filename);
+  e.remote_filename = std::move(remote_filename);
+  _entries.push_back(std::move(e));
+}
+
+/**
+ *  Get the error of the bundle, if any.
+ *
+ *  @return  The error, or an empty string.
+ */
+std::string const& file_bundle::get_error() const noexcept {
+  return (_error);
+}
+
+/**
+ *  Get the number of bytes sent.
+ *
+ *  @return  The size of the archive.
+ */
+unsigned long long file_bundle::get_size() const noexcept {
+  return (_size);
+}
+
+/**
+ *  Write the archive.
+ */
+void file_bundle::_run() {
+  try {
+    tar_writer writer(_proc);
+    for (auto const& e : _entries) {
+      struct stat st;
+      unsigned int mode = 0644;
+      if (::stat(e.local_filename.c_str(), &st) == 0)
+        mode = st.st_mode;
+      writer.add_file(e.remote_filename, e.content_filename, mode);
+    }
+    writer.finish();
+    _size = writer.get_size();
+  } catch (std::exception const& e) {
+    _error = e.what();
+  }
+  // Signal the end of the archive.
+  try {
+    _proc.enable_stream(process::in, false);
+  } catch (std::exception const& e) {
+    if (_error.empty())
+      _error = e.what();
+  }
+}
@@ -42,17 +42,16 @@ file_parser::~file_parser() noexcept {
 /**
  *  Parse the file.
  *
- *  @return  A tree parsed.
+ *  @return  A reader of the objects of the file.
  */
-xml::tree file_parser::parse() const {
-  xml::tree ret = xml::tree(
-    xmlReadFile(_file.path().c_str(), nullptr, XML_PARSE_NOBLANKS));
+xml::reader file_parser::parse() const {
+  xml::reader ret(_file.path());
 
   if (ret.null())
     throw (exceptions::basic()
            << "file_parser: couldn't parse '"
            << _file.file_name()
-           << "' : invalid xml format");
+           << "' : couldn't open file");
 
   return (std::move(ret));
 }
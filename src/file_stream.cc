@@ -0,0 +1,167 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include "com/centreon/cdash/file_stream.hh"
+#include "com/centreon/cdash/resolved_content.hh"
+#include "com/centreon/exceptions/basic.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] proc  The process receiving the content.
+ *  @param[in] fl    The file to send.
+ *  @param[in] obj   The object whose macros are used.
+ */
+file_stream::file_stream(
+               process& proc,
+               file const& fl,
+               object const& obj)
+  : _proc(proc),
+    _file(fl),
+    _obj(obj),
+    _size(0) {}
+
+/**
+ *  Destructor.
+ */
+file_stream::~file_stream() noexcept {}
+
+/**
+ *  Get the file sent.
+ *
+ *  @return  The file.
+ */
+file const& file_stream::get_file() const noexcept {
+  return (_file);
+}
+
+/**
+ *  Get the error of the stream, if any.
+ *
+ *  @return  The error, or an empty string.
+ */
+std::string const& file_stream::get_error() const noexcept {
+  return (_error);
+}
+
+/**
+ *  Get the number of bytes sent.
+ *
+ *  @return  The size of the content.
+ */
+unsigned long long file_stream::get_size() const noexcept {
+  return (_size);
+}
+
+/**
+ *  Write the size of the content, then the content.
+ *
+ *  The size lets the remote side keep only a complete content. A file
+ *  whose macros are resolved is resolved once, just before being sent,
+ *  into a resolved content released once sent.
+ */
+void file_stream::_run() {
+  try {
+    std::shared_ptr<resolved_content const> resolved;
+    unsigned long long size;
+    if (_file.resolve_macro()) {
+      resolved_content::writer writer;
+      _file.write_content(_obj, writer);
+      resolved = writer.commit();
+      size = resolved->get_size();
+    }
+    else {
+      struct stat st;
+      if (::stat(_file.get_local_filename().c_str(), &st) != 0) {
+        char const* error = ::strerror(errno);
+        throw (exceptions::basic()
+               << "file_stream: couldn't access the file '"
+               << _file.get_local_filename() << "': " << error);
+      }
+      size = st.st_size;
+    }
+    std::string header(std::to_string(size));
+    header.push_back('\n');
+    _write(header.data(), header.size());
+    _buffer.reserve(_buffer_size);
+    if (resolved)
+      file(resolved->get_path(), _file.get_remote_filename(), false)
+        .write_content(_obj, *this);
+    else
+      _file.write_content(_obj, *this);
+    if (_size != size)
+      throw (exceptions::basic()
+             << "file_stream: the content changed while being sent");
+    // Signal the end of the content.
+    _proc.enable_stream(process::in, false);
+  } catch (std::exception const& e) {
+    _error = e.what();
+  }
+  // The remote side must not keep a partial content.
+  if (!_error.empty())
+    _proc.terminate();
+}
+
+/**
+ *  Append a piece of the content.
+ *
+ *  Small pieces, such as macro contents, are gathered to write
+ *  them at once.
+ *
+ *  @param[in] data  The piece.
+ *  @param[in] size  The size of the piece.
+ */
+void file_stream::append(char const* data, size_t size) {
+  _size += size;
+  if (_buffer.size() + size > _buffer_size)
+    flush();
+  if (size >= _buffer_size)
+    _write(data, size);
+  else
+    _buffer.append(data, size);
+}
+
+/**
+ *  Write the pieces gathered so far.
+ */
+void file_stream::flush() {
+  _write(_buffer.data(), _buffer.size());
+  _buffer.clear();
+}
+
+/**
+ *  Write data on the standard input of the process.
+ *
+ *  @param[in] data  The data.
+ *  @param[in] size  The size of the data.
+ */
+void file_stream::_write(char const* data, size_t size) {
+  while (size > 0) {
+    unsigned int wb = _proc.write(data, size);
+    if (wb == 0)
+      throw (exceptions::basic()
+             << "file_stream: couldn't write the content");
+    data += wb;
+    size -= wb;
+  }
+}
+
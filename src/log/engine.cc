@@ -15,12 +15,12 @@
 */
 
 #include <iostream>
+#include "com/centreon/concurrency/locker.hh"
 #include "com/centreon/cdash/log/engine.hh"
 
+using namespace com::centreon;
 using namespace com::centreon::cdash::log;
 
-engine* engine::_p_engine = nullptr;
-
 /**
  *  Log something.
  *
@@ -30,10 +30,7 @@ engine* engine::_p_engine = nullptr;
 void engine::log(
                std::string const& name,
                std::string const& content) {
-  if (!_p_engine)
-    _p_engine = new engine;
-
-  _p_engine->_log(name, content);
+  _instance()._log(name, content);
 }
 
 /**
@@ -50,6 +47,19 @@ engine::~engine() noexcept {
 
 }
 
+/**
+ *  Get the engine.
+ *
+ *  It is never destroyed, so that it can log until the end of the
+ *  program.
+ *
+ *  @return  The engine.
+ */
+engine& engine::_instance() {
+  static engine* instance = new engine;
+  return (*instance);
+}
+
 /**
  *  Log something.
  *
@@ -63,6 +73,9 @@ void engine::_log(
               ? (std::string(_default_file_name))
               : (name + ".log");
 
+   // The lines of concurrent logs aren't mixed.
+   concurrency::locker lock(&_mutex);
+
    std::unique_ptr<std::ofstream>& ptr = _log_files[file_name];
    if (!ptr.get()) {
      try {
@@ -0,0 +1,426 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <algorithm>
+#include "com/centreon/concurrency/locker.hh"
+#include "com/centreon/cdash/macro_scope.hh"
+#include "com/centreon/cdash/macro_template.hh"
+#include "com/centreon/exceptions/basic.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] type  The type of the object of this scope.
+ */
+macro_scope::macro_scope(symbol_table::symbol type)
+  : _type(type) {}
+
+/**
+ *  Copy constructor.
+ *
+ *  Inherited scopes are shared with the copy. The resolved contents
+ *  aren't copied: the copy is made to be modified.
+ *
+ *  @param[in] other  The scope to copy.
+ */
+macro_scope::macro_scope(macro_scope const& other)
+  : _type(other._type),
+    _macros(other._macros),
+    _parents(other._parents),
+    _resolved(_macros.size(), symbol_table::not_found) {}
+
+/**
+ *  Destructor.
+ */
+macro_scope::~macro_scope() noexcept {}
+
+/**
+ *  Get the type of the object of this scope.
+ *
+ *  @return  The symbol of the type.
+ */
+symbol_table::symbol macro_scope::get_type() const noexcept {
+  return (_type);
+}
+
+/**
+ *  Find a macro.
+ *
+ *  @param[in]  name     Symbol of the name of the macro.
+ *  @param[out] content  Symbol of the content of the macro, if found.
+ *
+ *  @return  True if the macro was found.
+ */
+bool macro_scope::find(
+                    symbol_table::symbol name,
+                    symbol_table::symbol& content) const noexcept {
+  macro_scope const* owner;
+  size_t index;
+  if (!_find(name, owner, index))
+    return (false);
+  content = owner->_macros[index].second;
+  return (true);
+}
+
+/**
+ *  Find a macro by name.
+ *
+ *  @param[in]  name     Name of the macro.
+ *  @param[out] content  Symbol of the content of the macro, if found.
+ *
+ *  @return  True if the macro was found.
+ */
+bool macro_scope::find(
+                    std::string const& name,
+                    symbol_table::symbol& content) const noexcept {
+  symbol_table::symbol sym = symbol_table::find(name);
+  if (sym != symbol_table::not_found)
+    return (find(sym, content));
+  macro_scope const* owner;
+  size_t index;
+  if (!_find_not_interned(name, owner, index))
+    return (false);
+  content = owner->_macros[index].second;
+  return (true);
+}
+
+/**
+ *  Resolve a macro: get its content with its own macros replaced.
+ *
+ *  @param[in]  name   Symbol of the name of the macro.
+ *  @param[out] value  Symbol of the resolved content, if found.
+ *
+ *  @return  True if the macro was found.
+ */
+bool macro_scope::resolve(
+                    symbol_table::symbol name,
+                    symbol_table::symbol& value) const {
+  resolution_stack pending;
+  return (resolve(name, value, pending));
+}
+
+/**
+ *  Resolve a macro, as part of the resolution of other macros.
+ *
+ *  @param[in]     name     Symbol of the name of the macro.
+ *  @param[out]    value    Symbol of the resolved content, if found.
+ *  @param[in,out] pending  The macros being resolved.
+ *
+ *  @return  True if the macro was found.
+ */
+bool macro_scope::resolve(
+                    symbol_table::symbol name,
+                    symbol_table::symbol& value,
+                    resolution_stack& pending) const {
+  macro_scope const* owner;
+  size_t index;
+  if (!_find(name, owner, index))
+    return (false);
+  // A macro using its own name extends the inherited macro.
+  if (!pending.empty()
+      && pending.back().first == owner
+      && pending.back().second == index) {
+    macro_scope const* own = owner;
+    if (!own->_find_inherited(name, owner, index))
+      return (false);
+  }
+  value = owner->_resolve(index, pending);
+  return (true);
+}
+
+/**
+ *  Resolve a macro by name.
+ *
+ *  @param[in]  name   Name of the macro.
+ *  @param[out] value  Symbol of the resolved content, if found.
+ *
+ *  @return  True if the macro was found.
+ */
+bool macro_scope::resolve(
+                    std::string const& name,
+                    symbol_table::symbol& value) const {
+  symbol_table::symbol sym = symbol_table::find(name);
+  if (sym != symbol_table::not_found)
+    return (resolve(sym, value));
+  macro_scope const* owner;
+  size_t index;
+  if (!_find_not_interned(name, owner, index))
+    return (false);
+  resolution_stack pending;
+  value = owner->_resolve(index, pending);
+  return (true);
+}
+
+/**
+ *  Set an own macro.
+ *
+ *  @param[in] name     Symbol of the name of the macro.
+ *  @param[in] content  Symbol of the content of the macro.
+ */
+void macro_scope::set(
+                    symbol_table::symbol name,
+                    symbol_table::symbol content) {
+  macro_list::iterator it = std::lower_bound(
+    _macros.begin(),
+    _macros.end(),
+    std::make_pair(name, symbol_table::empty));
+  if (it != _macros.end() && it->first == name)
+    it->second = content;
+  else
+    _macros.insert(it, std::make_pair(name, content));
+  _clear_resolved();
+}
+
+/**
+ *  Inherit a scope. It has precedence over the scopes inherited before.
+ *
+ *  @param[in] parent  The inherited scope.
+ */
+void macro_scope::inherit(std::shared_ptr<macro_scope const> parent) {
+  _parents.push_back(std::move(parent));
+  _clear_resolved();
+}
+
+/**
+ *  Get all the macros visible in this scope.
+ *
+ *  @return  The macros, sorted by name, with their unresolved content.
+ */
+macro_scope::macro_list macro_scope::flatten() const {
+  std::map<symbol_table::symbol, symbol_table::symbol> macros;
+  _flatten(macros);
+  return (macro_list(macros.begin(), macros.end()));
+}
+
+/**
+ *  Find a macro.
+ *
+ *  @param[in]  name   Symbol of the name of the macro.
+ *  @param[out] owner  The scope defining the macro, if found.
+ *  @param[out] index  The index of the macro in its owner.
+ *
+ *  @return  True if the macro was found.
+ */
+bool macro_scope::_find(
+                    symbol_table::symbol name,
+                    macro_scope const*& owner,
+                    size_t& index) const noexcept {
+  symbol_table::symbol type = symbol_table::not_found;
+  symbol_table::symbol unqualified = symbol_table::not_found;
+  bool qualified = symbol_table::split_qualified(name, type, unqualified);
+  return (_find(name, qualified, type, unqualified, owner, index));
+}
+
+/**
+ *  Find a macro.
+ *
+ *  @param[in]  name         Symbol of the name of the macro.
+ *  @param[in]  qualified    Is the name a qualified name, 'type.name'?
+ *  @param[in]  type         The type of a qualified name.
+ *  @param[in]  unqualified  The name of a qualified name.
+ *  @param[out] owner        The scope defining the macro, if found.
+ *  @param[out] index        The index of the macro in its owner.
+ *
+ *  @return  True if the macro was found.
+ */
+bool macro_scope::_find(
+                    symbol_table::symbol name,
+                    bool qualified,
+                    symbol_table::symbol type,
+                    symbol_table::symbol unqualified,
+                    macro_scope const*& owner,
+                    size_t& index) const noexcept {
+  macro_list::const_iterator it = std::lower_bound(
+    _macros.begin(),
+    _macros.end(),
+    std::make_pair(name, symbol_table::empty));
+  if (it != _macros.end() && it->first == name) {
+    owner = this;
+    index = it - _macros.begin();
+    return (true);
+  }
+  return (_find_inherited(name, qualified, type, unqualified, owner, index));
+}
+
+/**
+ *  Find a macro in the inherited scopes only.
+ *
+ *  @param[in]  name   Symbol of the name of the macro.
+ *  @param[out] owner  The scope defining the macro, if found.
+ *  @param[out] index  The index of the macro in its owner.
+ *
+ *  @return  True if the macro was found.
+ */
+bool macro_scope::_find_inherited(
+                    symbol_table::symbol name,
+                    macro_scope const*& owner,
+                    size_t& index) const noexcept {
+  symbol_table::symbol type = symbol_table::not_found;
+  symbol_table::symbol unqualified = symbol_table::not_found;
+  bool qualified = symbol_table::split_qualified(name, type, unqualified);
+  return (_find_inherited(name, qualified, type, unqualified, owner, index));
+}
+
+/**
+ *  Find a macro in the inherited scopes only.
+ *
+ *  @param[in]  name         Symbol of the name of the macro.
+ *  @param[in]  qualified    Is the name a qualified name, 'type.name'?
+ *  @param[in]  type         The type of a qualified name.
+ *  @param[in]  unqualified  The name of a qualified name.
+ *  @param[out] owner        The scope defining the macro, if found.
+ *  @param[out] index        The index of the macro in its owner.
+ *
+ *  @return  True if the macro was found.
+ */
+bool macro_scope::_find_inherited(
+                    symbol_table::symbol name,
+                    bool qualified,
+                    symbol_table::symbol type,
+                    symbol_table::symbol unqualified,
+                    macro_scope const*& owner,
+                    size_t& index) const noexcept {
+  for (auto parent = _parents.rbegin(); parent != _parents.rend(); ++parent) {
+    if ((*parent)->_find(name, qualified, type, unqualified, owner, index))
+      return (true);
+    if (qualified
+        && (*parent)->_type == type
+        && (*parent)->_find(unqualified, owner, index))
+      return (true);
+  }
+  return (false);
+}
+
+/**
+ *  Find a macro whose name was never interned.
+ *
+ *  Such a macro can only be a qualified name, 'type.name', of an
+ *  inherited scope: qualified names aren't interned when inheriting.
+ *
+ *  @param[in]  name   Name of the macro.
+ *  @param[out] owner  The scope defining the macro, if found.
+ *  @param[out] index  The index of the macro in its owner.
+ *
+ *  @return  True if the macro was found.
+ */
+bool macro_scope::_find_not_interned(
+                    std::string const& name,
+                    macro_scope const*& owner,
+                    size_t& index) const noexcept {
+  size_t dot = name.find('.');
+  if (dot == std::string::npos)
+    return (false);
+  symbol_table::symbol type = symbol_table::find(name.substr(0, dot));
+  if (type == symbol_table::not_found)
+    return (false);
+  std::string unqualified = name.substr(dot + 1);
+  for (auto parent = _parents.rbegin(); parent != _parents.rend(); ++parent) {
+    if ((*parent)->_find_not_interned(name, owner, index))
+      return (true);
+    if ((*parent)->_type == type) {
+      symbol_table::symbol sym = symbol_table::find(unqualified);
+      if (sym != symbol_table::not_found
+          ? (*parent)->_find(sym, owner, index)
+          : (*parent)->_find_not_interned(unqualified, owner, index))
+        return (true);
+    }
+  }
+  return (false);
+}
+
+/**
+ *  Resolve an own macro.
+ *
+ *  The content is resolved in this scope, once: the result is kept
+ *  for the next lookups, from this scope or from the scopes
+ *  inheriting it.
+ *
+ *  @param[in]     index    The index of the macro.
+ *  @param[in,out] pending  The macros being resolved.
+ *
+ *  @return  Symbol of the resolved content.
+ */
+symbol_table::symbol macro_scope::_resolve(
+                       size_t index,
+                       resolution_stack& pending) const {
+  {
+    concurrency::locker lock(&_resolved_mutex);
+    if (_resolved.size() != _macros.size())
+      _resolved.assign(_macros.size(), symbol_table::not_found);
+    else if (_resolved[index] != symbol_table::not_found)
+      return (_resolved[index]);
+  }
+
+  symbol_table::symbol content = _macros[index].second;
+  symbol_table::symbol value = content;
+  if (symbol_table::get(content).find('$') != std::string::npos) {
+    for (auto const& p : pending)
+      if (p.first == this && p.second == index) {
+        std::string cycle;
+        for (auto const& q : pending)
+          cycle.append(symbol_table::get(q.first->_macros[q.second].first))
+               .append(" -> ");
+        cycle.append(symbol_table::get(_macros[index].first));
+        throw (exceptions::basic()
+               << "macro_scope: macro '"
+               << symbol_table::get(_macros[index].first)
+               << "' depends on itself: " << cycle);
+      }
+    pending.push_back(std::make_pair(this, index));
+    value = symbol_table::intern(
+              macro_template::compile(content)
+                ->evaluate(*this, pending));
+    pending.pop_back();
+  }
+
+  // Resolved without the lock: other threads may resolve the same macro.
+  concurrency::locker lock(&_resolved_mutex);
+  _resolved[index] = value;
+  return (value);
+}
+
+/**
+ *  Forget the resolved contents, after a modification of this scope.
+ */
+void macro_scope::_clear_resolved() {
+  concurrency::locker lock(&_resolved_mutex);
+  _resolved.assign(_macros.size(), symbol_table::not_found);
+}
+
+/**
+ *  Get all the macros visible in this scope.
+ *
+ *  @param[in,out] macros  The macros, overwritten by those of this scope.
+ */
+void macro_scope::_flatten(
+                    std::map<symbol_table::symbol, symbol_table::symbol>&
+                      macros) const {
+  for (auto const& parent : _parents) {
+    std::map<symbol_table::symbol, symbol_table::symbol> inherited;
+    parent->_flatten(inherited);
+    // Names inherited as is have precedence over the qualified ones.
+    for (auto const& macro : inherited)
+      macros[symbol_table::intern_qualified(parent->_type, macro.first)]
+        = macro.second;
+    for (auto const& macro : inherited)
+      macros[macro.first] = macro.second;
+  }
+  for (auto const& macro : _macros)
+    macros[macro.first] = macro.second;
+}
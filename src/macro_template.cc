@@ -0,0 +1,215 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <cstring>
+#include "com/centreon/concurrency/locker.hh"
+#include "com/centreon/cdash/macro_template.hh"
+#include "com/centreon/exceptions/basic.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+/**
+ *  Constructor. Parse a string.
+ *
+ *  @param[in] source  The string.
+ */
+macro_template::macro_template(std::string const& source)
+  : _literal_size(0) {
+  segment current;
+  current.macro = symbol_table::not_found;
+  size_t index = 0;
+  for (size_t first_of = source.find('$', index);
+       first_of != std::string::npos;
+       first_of = source.find('$', index)) {
+    size_t second_of = source.find('$', first_of + 1);
+    if (second_of == std::string::npos)
+      throw (exceptions::basic()
+             << "couldn't find closing '$' in '" << source << "'");
+    current.literal.append(source, index, first_of - index);
+    if (second_of == first_of + 1)
+      current.literal.append(1, '$');
+    else {
+      current.macro = symbol_table::intern(
+        source.substr(first_of + 1, second_of - first_of - 1));
+      _literal_size += current.literal.size();
+      _segments.push_back(std::move(current));
+      current.literal.clear();
+      current.macro = symbol_table::not_found;
+    }
+    index = second_of + 1;
+  }
+  current.literal.append(source, index, std::string::npos);
+  _literal_size += current.literal.size();
+  _segments.push_back(std::move(current));
+}
+
+/**
+ *  Destructor.
+ */
+macro_template::~macro_template() noexcept {}
+
+/**
+ *  Get the compiled template of a macro content.
+ *
+ *  Templates of macro contents are cached: a content used by many
+ *  objects is parsed only once. Other strings, used once, are compiled
+ *  by the constructor and not cached.
+ *
+ *  @param[in] source  The symbol of the content.
+ *
+ *  @return  The compiled template.
+ */
+std::shared_ptr<macro_template const> macro_template::compile(
+                                        symbol_table::symbol source) {
+  cache& c = _get_cache();
+  {
+    concurrency::locker lock(&c.mut);
+    auto found = c.templates.find(source);
+    if (found != c.templates.end())
+      return (found->second);
+  }
+  // Parsed without the lock: other threads may parse the same string.
+  std::shared_ptr<macro_template const> tmpl(
+    new macro_template(symbol_table::get(source)));
+  concurrency::locker lock(&c.mut);
+  // XXX: No emplace because GCC 4.7.
+  return (c.templates.insert(std::make_pair(source, tmpl)).first->second);
+}
+
+/**
+ *  Escape a string, so that it is its own template.
+ *
+ *  @param[in] str  The string.
+ *
+ *  @return  The string with '$' doubled.
+ */
+std::string macro_template::escape(std::string const& str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (char c : str) {
+    if (c == '$')
+      escaped.push_back('$');
+    escaped.push_back(c);
+  }
+  return (escaped);
+}
+
+/**
+ *  Replace the macros of the template.
+ *
+ *  @param[in] scope  The macros.
+ *
+ *  @return  The string with the macros replaced.
+ */
+std::string macro_template::evaluate(macro_scope const& scope) const {
+  macro_scope::resolution_stack pending;
+  return (evaluate(scope, pending));
+}
+
+/**
+ *  Replace the macros of the template, as part of the resolution of
+ *  other macros.
+ *
+ *  @param[in]     scope    The macros.
+ *  @param[in,out] pending  The macros being resolved.
+ *
+ *  @return  The string with the macros replaced.
+ */
+std::string macro_template::evaluate(
+                              macro_scope const& scope,
+                              macro_scope::resolution_stack& pending) const {
+  // Find the macros first, to allocate the result once.
+  std::vector<std::string const*> contents(_segments.size(), nullptr);
+  size_t size = _literal_size;
+  for (size_t i = 0; i < _segments.size(); ++i) {
+    symbol_table::symbol content;
+    if (_segments[i].macro != symbol_table::not_found
+        && scope.resolve(_segments[i].macro, content, pending)) {
+      contents[i] = &symbol_table::get(content);
+      size += contents[i]->size();
+    }
+  }
+
+  std::string result;
+  result.reserve(size);
+  for (size_t i = 0; i < _segments.size(); ++i) {
+    result.append(_segments[i].literal);
+    if (contents[i])
+      result.append(*contents[i]);
+  }
+  return (result);
+}
+
+/**
+ *  Replace the macros of a string, without compiling it.
+ *
+ *  Used for large strings, like the content of files: the string isn't
+ *  copied, nor cached. Its literal parts and the contents of its macros
+ *  are given to the sink as is, and must be used before the string and
+ *  the symbol table are released.
+ *
+ *  @param[in]  data   The string.
+ *  @param[in]  size   The size of the string.
+ *  @param[in]  scope  The macros.
+ *  @param[out] out    Receive the string with the macros replaced.
+ */
+void macro_template::evaluate(
+                       char const* data,
+                       size_t size,
+                       macro_scope const& scope,
+                       sink& out) {
+  char const* end = data + size;
+  char const* index = data;
+  while (index < end) {
+    char const* first_of
+      = static_cast<char const*>(::memchr(index, '$', end - index));
+    if (!first_of)
+      break ;
+    char const* second_of = static_cast<char const*>(
+      ::memchr(first_of + 1, '$', end - first_of - 1));
+    if (!second_of)
+      throw (exceptions::basic()
+             << "couldn't find closing '$' at offset " << (first_of - data));
+    out.append(index, first_of - index);
+    if (second_of == first_of + 1)
+      out.append(first_of, 1);
+    else {
+      char const* name = first_of + 1;
+      size_t name_size = second_of - name;
+      symbol_table::symbol sym = symbol_table::find(name, name_size);
+      symbol_table::symbol content;
+      if (sym != symbol_table::not_found ?
+            scope.resolve(sym, content) :
+            scope.resolve(std::string(name, name_size), content)) {
+        std::string const& str = symbol_table::get(content);
+        out.append(str.data(), str.size());
+      }
+    }
+    index = second_of + 1;
+  }
+  out.append(index, end - index);
+}
+
+/**
+ *  Get the cache of the compiled templates.
+ *
+ *  @return  The cache.
+ */
+macro_template::cache& macro_template::_get_cache() {
+  static cache c;
+  return (c);
+}
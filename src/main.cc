@@ -19,14 +19,17 @@
 #include <ctime>
 #include <string>
 #include <iostream>
+#include <memory>
 #include "com/centreon/cdash/args_parser.hh"
-#include "com/centreon/cdash/file_parser.hh"
-#include "com/centreon/cdash/xml_tree_parser.hh"
+#include "com/centreon/cdash/config_cache.hh"
+#include "com/centreon/cdash/config_file.hh"
 #include "com/centreon/cdash/task_manager.hh"
 #include "com/centreon/cdash/object.hh"
 #include "com/centreon/cdash/task.hh"
+#include "com/centreon/cdash/task_builder.hh"
 #include "com/centreon/cdash/sequence.hh"
 #include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/concurrency/thread_pool.hh"
 #include "com/centreon/cdash/xml/library.hh"
 #include "com/centreon/aws/ec2/command.hh"
 #include "com/centreon/process_manager.hh"
@@ -46,6 +49,7 @@ static void signal_handler(int sig) {
   if (sig == SIGTERM || sig == SIGINT) {
     std::cout << "termination asked, exiting..." << std::endl;
     cdash::task_manager::should_exit = true;
+    cdash::task_manager::wake_up();
   }
 }
 
@@ -66,8 +70,12 @@ int main(int argc, char* argv[]) {
     ::sigemptyset(&sig.sa_mask);
     ::sigfillset(&sig.sa_mask);
     sig.sa_flags = 0;
+    // SIGPIPE is caught, not ignored, so that writes to a dead ssh
+    // process fail with EPIPE while the children still get the
+    // default action.
     if (::sigaction(SIGTERM, &sig, nullptr) < 0
-        || ::sigaction(SIGINT, &sig, nullptr) < 0) {
+        || ::sigaction(SIGINT, &sig, nullptr) < 0
+        || ::sigaction(SIGPIPE, &sig, nullptr) < 0) {
       std::cerr << "can't set signal handlers" << std::endl;
       return (-1);
     }
@@ -95,39 +103,96 @@ int main(int argc, char* argv[]) {
   std::vector<std::vector<object>> sequence_objects;
   std::string profile;
 
-  {
+  // The configuration cache skips the parsing and the resolution of the
+  // files when nothing changed.
+  std::unique_ptr<config_cache> cache;
+  if (!parser.get_argument('n').is_set()) {
+    cache.reset(new config_cache(parser.get_parameters()));
+    if (parser.get_argument('c').is_set())
+      cache->clear();
+  }
+  bool cached = cache.get() && cache->load(sequence_objects, profile);
+
+  if (!cached) {
     // Initialize xml library.
     xml::library _;
 
-    // Parse files.
-    for (auto const& parameter : parser.get_parameters()) {
-      try {
-        file_parser fp(parameter);
-        xml_tree_parser xtp(fp.parse());
-        xtp.parse(sequence_objects, profile);
-      } catch (std::exception const& e) {
-        std::cerr << "couldn't parse configuration: " << e.what() << std::endl;
+    // Parse files concurrently, one thread per core.
+    std::vector<std::unique_ptr<config_file>> files;
+    {
+      concurrency::thread_pool pool;
+      for (auto const& parameter : parser.get_parameters()) {
+        std::unique_ptr<config_file> file(new config_file(parameter));
+        pool.start(file.get());
+        files.push_back(std::move(file));
+      }
+      pool.wait_for_done();
+    }
+
+    // Merge them in command-line order.
+    std::string profile_filename;
+    for (auto const& file : files) {
+      if (!file->get_error().empty()) {
+        std::cerr
+          << "couldn't parse configuration '" << file->get_filename()
+          << "': " << file->get_error() << std::endl;
         return (-1);
       }
+      if (!file->get_profile().empty()) {
+        if (!profile.empty() && profile != file->get_profile()) {
+          std::cerr
+            << "couldn't parse configuration: conflicting profiles '"
+            << profile << "' in '" << profile_filename << "' and '"
+            << file->get_profile() << "' in '" << file->get_filename()
+            << "'" << std::endl;
+          return (-1);
+        }
+        profile = file->get_profile();
+        profile_filename = file->get_filename();
+      }
+      for (auto& objects : file->get_sequences())
+        sequence_objects.push_back(std::move(objects));
     }
   }
 
-  // Create sequences.
-  std::vector<sequence> sequences;
-  try {
+  // Create tasks concurrently, one thread per core.
+  std::vector<std::vector<std::unique_ptr<task_builder>>> builders;
+  {
+    concurrency::thread_pool pool;
     for (auto& objects : sequence_objects) {
-      sequence seq;
-      for (auto& object : objects)
-        seq.add_task(task(object));
-      sequences.emplace_back(std::move(seq));
+      std::vector<std::unique_ptr<task_builder>> sequence_builders;
+      for (auto& object : objects) {
+        std::unique_ptr<task_builder> builder(
+          new task_builder(std::move(object), !cached));
+        pool.start(builder.get());
+        sequence_builders.push_back(std::move(builder));
+      }
+      builders.push_back(std::move(sequence_builders));
     }
-  } catch (std::exception const& e) {
-    std::cerr << "couldn't create tasks: " << e.what() << std::endl;
-    return (-1);
+    pool.wait_for_done();
+  }
+  sequence_objects.clear();
+
+  // Create sequences, in configuration order.
+  std::vector<sequence> sequences;
+  for (auto& sequence_builders : builders) {
+    sequence seq;
+    for (auto& builder : sequence_builders) {
+      if (!builder->get_error().empty()) {
+        std::cerr
+          << "couldn't create tasks: " << builder->get_error() << std::endl;
+        return (-1);
+      }
+      seq.add_task(std::move(builder->get_task()));
+    }
+    sequences.emplace_back(std::move(seq));
   }
+  builders.clear();
 
   std::cout << "resolved " << sequences.size()
             << " sequence(s) of tasks" << std::endl;
+  if (cache.get() && !cached)
+    cache->save(sequences, profile);
 
   // Create task manager.
   try {
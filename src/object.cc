@@ -14,8 +14,8 @@
 ** limitations under the License.
 */
 
+#include "com/centreon/cdash/macro_template.hh"
 #include "com/centreon/cdash/object.hh"
-#include "com/centreon/exceptions/basic.hh"
 
 using namespace com::centreon;
 using namespace com::centreon::cdash;
@@ -26,7 +26,8 @@ using namespace com::centreon::cdash;
  *  @param[in] type  The type of this object.
  */
 object::object(std::string type)
-  : _type(std::move(type)) {}
+  : _type(std::move(type)),
+    _scope(std::make_shared<macro_scope>(symbol_table::intern(_type))) {}
 
 /**
  *  Copy constructor.
@@ -36,7 +37,7 @@ object::object(std::string type)
 object::object(object const& obj)
   : _name(obj._name),
     _type(obj._type),
-    _macros(obj._macros),
+    _scope(obj._scope),
     _files(obj._files),
     _returned_files(obj._returned_files) {}
 
@@ -51,7 +52,7 @@ object& object::operator=(object const& obj) {
   if (this != &obj) {
     _name = obj._name;
     _type = obj._type;
-    _macros = obj._macros;
+    _scope = obj._scope;
     _files = obj._files;
     _returned_files = obj._returned_files;
   }
@@ -66,7 +67,7 @@ object& object::operator=(object const& obj) {
 object::object(object&& obj) noexcept
   : _name(std::move(obj._name)),
     _type(std::move(obj._type)),
-    _macros(std::move(obj._macros)),
+    _scope(std::move(obj._scope)),
     _files(std::move(obj._files)),
     _returned_files(std::move(obj._returned_files)) {}
 
@@ -81,7 +82,7 @@ object& object::operator=(object&& obj) noexcept {
   if (this != &obj) {
     _name = std::move(obj._name);
     _type = std::move(obj._type);
-    _macros = std::move(obj._macros);
+    _scope = std::move(obj._scope);
     _files = std::move(obj._files);
     _returned_files = std::move(obj._returned_files);
   }
@@ -102,7 +103,7 @@ object::~object() noexcept {
  */
 void object::set_name(std::string name) {
   _name = std::move(name);
-  set_macro("name", _name);
+  set_macro("name", macro_template::escape(_name));
 }
 
 /**
@@ -131,7 +132,20 @@ std::string const& object::get_type() const noexcept {
  *  @return          True if the macro exists.
  */
 bool object::macro_exists(std::string const& name) const noexcept {
-  return (_macros.find(name) != _macros.end());
+  symbol_table::symbol content;
+  return (_scope->find(name, content));
+}
+
+/**
+ *  Check for macro existence.
+ *
+ *  @param[in] name  Symbol of the name of the macro.
+ *
+ *  @return          True if the macro exists.
+ */
+bool object::macro_exists(symbol_table::symbol name) const noexcept {
+  symbol_table::symbol content;
+  return (_scope->find(name, content));
 }
 
 /**
@@ -139,12 +153,29 @@ bool object::macro_exists(std::string const& name) const noexcept {
  *
  *  @param[in] name  Name of the macro.
  *
- *  @return          The content of the macro, or an empty string.
+ *  @return          The resolved content of the macro, or an empty
+ *                   string. It lives as long as the program.
+ */
+std::string const& object::macro_content(std::string const& name) const {
+  symbol_table::symbol content;
+  if (!_scope->resolve(name, content))
+    content = symbol_table::empty;
+  return (symbol_table::get(content));
+}
+
+/**
+ *  Get the content of a macro.
+ *
+ *  @param[in] name  Symbol of the name of the macro.
+ *
+ *  @return          The resolved content of the macro, or an empty
+ *                   string. It lives as long as the program.
  */
-std::string object::macro_content(std::string const& name) const noexcept {
-  std::map<std::string, std::string>::const_iterator found
-    = _macros.find(name);
-   return (found != _macros.end() ? found->second : std::string());
+std::string const& object::macro_content(symbol_table::symbol name) const {
+  symbol_table::symbol content;
+  if (!_scope->resolve(name, content))
+    content = symbol_table::empty;
+  return (symbol_table::get(content));
 }
 
 /**
@@ -153,25 +184,48 @@ std::string object::macro_content(std::string const& name) const noexcept {
  *  @param[in] name     The name of the macro.
  *  @param[in] content  The content of the macro.
  */
-void object::set_macro(std::string name, std::string content) {
-  _macros[std::move(name)] = std::move(content);
+void object::set_macro(std::string const& name, std::string const& content) {
+  set_macro(symbol_table::intern(name), symbol_table::intern(content));
+}
+
+/**
+ *  Set a macro. Its content can use other macros, resolved when the
+ *  macro is.
+ *
+ *  @param[in] name     Symbol of the name of the macro.
+ *  @param[in] content  Symbol of the content of the macro.
+ */
+void object::set_macro(
+               symbol_table::symbol name,
+               symbol_table::symbol content) {
+  // Report syntax errors now rather than on the first use.
+  macro_template::compile(content);
+  _get_scope_mut().set(name, content);
+}
+
+/**
+ *  Get all the macros, own and inherited.
+ *
+ *  @return  The macros, sorted by name, with their resolved content.
+ */
+object::macro_list object::get_macros() const {
+  macro_list macros(_scope->flatten());
+  for (auto& macro : macros)
+    _scope->resolve(macro.first, macro.second);
+  return (macros);
 }
 
 /**
  *  Inherit all the macros and files of another object.
  *
+ *  The macros of the other object are shared, not copied: they are
+ *  accessible as is, and prefixed by its type. So are its files.
+ *
  *  @param[in] obj  The other object.
  */
 void object::inherit_macros(object const& obj) {
-  for (auto const& macro : obj._macros) {
-    set_macro(macro.first, macro.second);
-    set_macro(std::string(obj.get_type()) + "." + macro.first, macro.second);
-  }
-  for (auto const& file : obj._files)
-    add_file(
-      file.get_local_filename(),
-      file.get_remote_filename(),
-      file.resolve_macro());
+  _get_scope_mut().inherit(obj._scope);
+  _files.insert(_files.end(), obj._files.begin(), obj._files.end());
 }
 
 /**
@@ -182,21 +236,22 @@ void object::inherit_macros(object const& obj) {
  *  @return         The string with macros resolved.
  */
 std::string object::resolve_macros(std::string str) const {
-  size_t index = 0;
-  for (size_t first_of = str.find_first_of('$', index);
-       first_of != std::string::npos;
-       first_of = str.find_first_of('$', index)) {
-    size_t second_of = str.find_first_of('$', first_of + 1);
-    if (second_of == std::string::npos)
-      throw (exceptions::basic()
-             << "couldn't find closing '$' in '" << str << "'");
-    second_of -= first_of;
-    std::string substr = str.substr(first_of + 1, second_of - 1);
-    std::string replaced = substr.empty() ? "$" : macro_content(substr);
-    str.replace(first_of, second_of + 1, replaced);
-    index = first_of + 1;
-  }
-  return (std::move(str));
+  // Not cached: such strings are used once.
+  return (macro_template(str).evaluate(*_scope));
+}
+
+/**
+ *  Resolve the macros in a large string, like the content of a file.
+ *
+ *  @param[in]  data  The string.
+ *  @param[in]  size  The size of the string.
+ *  @param[out] out   Receive the string with macros resolved.
+ */
+void object::resolve_macros(
+               char const* data,
+               size_t size,
+               macro_template::sink& out) const {
+  macro_template::evaluate(data, size, *_scope, out);
 }
 
 /**
@@ -257,3 +312,16 @@ std::vector<file>& object::get_files_mut() noexcept {
 std::vector<file> const& object::get_returned_files() const noexcept {
   return (_returned_files);
 }
+
+/**
+ *  Get the scope of this object, to modify it.
+ *
+ *  The scope is copied first if it is shared.
+ *
+ *  @return  The scope of this object.
+ */
+macro_scope& object::_get_scope_mut() {
+  if (!_scope.unique())
+    _scope = std::make_shared<macro_scope>(*_scope);
+  return (*_scope);
+}
@@ -0,0 +1,336 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+#include "com/centreon/concurrency/locker.hh"
+#include "com/centreon/cdash/log/error.hh"
+#include "com/centreon/cdash/resolved_content.hh"
+#include "com/centreon/exceptions/basic.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+static char const* directory_template = "/tmp/cdash-resolved-XXXXXX";
+
+/**
+ *  Compare the contents of two files.
+ *
+ *  @param[in] first   The path of the first file.
+ *  @param[in] second  The path of the second file.
+ *
+ *  @return  True if the files could be read and have the same content.
+ */
+static bool same_content(std::string const& first, std::string const& second) {
+  int first_fd = ::open(first.c_str(), O_RDONLY | O_CLOEXEC);
+  int second_fd = ::open(second.c_str(), O_RDONLY | O_CLOEXEC);
+  bool same = (first_fd != -1 && second_fd != -1);
+  while (same) {
+    char first_buffer[64 * 1024];
+    char second_buffer[sizeof(first_buffer)];
+    ssize_t first_rb = ::read(first_fd, first_buffer, sizeof(first_buffer));
+    if (first_rb < 0 && errno == EINTR)
+      continue ;
+    if (first_rb <= 0) {
+      // Both files must end here.
+      char c;
+      same = (first_rb == 0 && ::read(second_fd, &c, 1) == 0);
+      break ;
+    }
+    // Read as much from the second file.
+    ssize_t second_size = 0;
+    while (same && second_size < first_rb) {
+      ssize_t rb = ::read(
+                     second_fd,
+                     second_buffer + second_size,
+                     first_rb - second_size);
+      if (rb < 0 && errno == EINTR)
+        continue ;
+      if (rb <= 0)
+        same = false;
+      else
+        second_size += rb;
+    }
+    if (same)
+      same = (::memcmp(first_buffer, second_buffer, first_rb) == 0);
+  }
+  if (first_fd != -1)
+    ::close(first_fd);
+  if (second_fd != -1)
+    ::close(second_fd);
+  return (same);
+}
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] k     The key of the content.
+ *  @param[in] path  The file of the content.
+ */
+resolved_content::resolved_content(key k, std::string path)
+  : _key(k),
+    _path(std::move(path)) {}
+
+/**
+ *  Destructor. Remove the file of the content.
+ */
+resolved_content::~resolved_content() noexcept {
+  registry& r = _get_registry();
+  {
+    concurrency::locker lock(&r.mut);
+    auto found = r.contents.find(_key);
+    // Another content may have replaced this one in the registry.
+    if (found != r.contents.end() && found->second.first == this)
+      r.contents.erase(found);
+  }
+  ::unlink(_path.c_str());
+}
+
+/**
+ *  Store a resolved content, or share it if it's already stored.
+ *
+ *  @param[in] content  The content.
+ *
+ *  @return  The stored content.
+ */
+std::shared_ptr<resolved_content const> resolved_content::store(
+                                           std::string const& content) {
+  writer w;
+  w.append(content.data(), content.size());
+  return (w.commit());
+}
+
+/**
+ *  Get the file of the content.
+ *
+ *  @return  The path of the file.
+ */
+std::string const& resolved_content::get_path() const noexcept {
+  return (_path);
+}
+
+/**
+ *  Get the size of the content.
+ *
+ *  @return  The size of the content.
+ */
+size_t resolved_content::get_size() const noexcept {
+  return (_key.second);
+}
+
+/**
+ *  Constructor. Create a temporary file for the content.
+ */
+resolved_content::writer::writer()
+  : _fd(-1),
+    _size(0) {
+  registry& r = _get_registry();
+  {
+    concurrency::locker lock(&r.mut);
+    if (r.directory.empty())
+      throw (exceptions::basic()
+             << "resolved_content: couldn't create the directory of the "
+                "resolved files");
+    _id = r.next_id++;
+    _path = r.directory + "/tmp-" + std::to_string(_id);
+  }
+  _fd = ::open(_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (_fd == -1) {
+    char const* error = ::strerror(errno);
+    throw (exceptions::basic()
+           << "resolved_content: couldn't create '" << _path
+           << "': " << error);
+  }
+}
+
+/**
+ *  Destructor. Remove the temporary file if the content wasn't
+ *  committed.
+ */
+resolved_content::writer::~writer() noexcept {
+  if (_fd != -1) {
+    ::close(_fd);
+    ::unlink(_path.c_str());
+  }
+}
+
+/**
+ *  Append a piece of the content.
+ *
+ *  The piece isn't copied: it must stay valid until the next flush.
+ *
+ *  @param[in] data  The piece.
+ *  @param[in] size  The size of the piece.
+ */
+void resolved_content::writer::append(char const* data, size_t size) {
+  if (!size)
+    return ;
+  iovec piece;
+  piece.iov_base = const_cast<char*>(data);
+  piece.iov_len = size;
+  _pending.push_back(piece);
+  _digest.update(data, size);
+  _size += size;
+  if (_pending.size() >= IOV_MAX)
+    _flush();
+}
+
+/**
+ *  Write the pieces appended so far.
+ */
+void resolved_content::writer::flush() {
+  _flush();
+}
+
+/**
+ *  Store the content, or share it if the same content is already
+ *  stored.
+ *
+ *  Contents with the same digest are compared before being shared.
+ *  Different contents with the same digest aren't shared.
+ *
+ *  @return  The stored content.
+ */
+std::shared_ptr<resolved_content const> resolved_content::writer::commit() {
+  _flush();
+  ::close(_fd);
+  _fd = -1;
+
+  key k(_digest.get_value(), _size);
+  registry& r = _get_registry();
+  std::shared_ptr<resolved_content const> shared;
+  {
+    concurrency::locker lock(&r.mut);
+    auto found = r.contents.find(k);
+    if (found != r.contents.end())
+      shared = found->second.second.lock();
+  }
+  // Compared without the lock: files can be big.
+  if (shared && same_content(_path, shared->get_path())) {
+    ::unlink(_path.c_str());
+    return (shared);
+  }
+
+  // Renamed without the lock: other threads may store the same content.
+  std::string path(
+    _path.substr(0, _path.rfind('/') + 1) + _digest.to_string()
+    + "-" + std::to_string(_id));
+  if (::rename(_path.c_str(), path.c_str()) != 0) {
+    char const* error = ::strerror(errno);
+    ::unlink(_path.c_str());
+    throw (exceptions::basic()
+           << "resolved_content: couldn't rename '" << _path
+           << "' into '" << path << "': " << error);
+  }
+  std::shared_ptr<resolved_content const> stored(
+    new resolved_content(k, path));
+
+  {
+    concurrency::locker lock(&r.mut);
+    auto& entry = r.contents[k];
+    shared = entry.second.lock();
+    if (!shared) {
+      entry.first = stored.get();
+      entry.second = stored;
+      return (stored);
+    }
+  }
+  // Another content has the same digest: share it only if it's the same.
+  if (same_content(path, shared->get_path()))
+    return (shared);
+  return (stored);
+}
+
+/**
+ *  Write the pending pieces of the content.
+ */
+void resolved_content::writer::_flush() {
+  size_t index = 0;
+  while (index < _pending.size()) {
+    ssize_t wb = ::writev(
+                   _fd,
+                   &_pending[index],
+                   std::min<size_t>(_pending.size() - index, IOV_MAX));
+    if (wb < 0 && errno == EINTR)
+      continue ;
+    if (wb < 0) {
+      char const* error = ::strerror(errno);
+      throw (exceptions::basic()
+             << "resolved_content: couldn't write '" << _path
+             << "': " << error);
+    }
+    // Skip what was written, partial writes included.
+    size_t written = wb;
+    while (written > 0) {
+      iovec& piece = _pending[index];
+      if (written >= piece.iov_len) {
+        written -= piece.iov_len;
+        ++index;
+      }
+      else {
+        piece.iov_base = static_cast<char*>(piece.iov_base) + written;
+        piece.iov_len -= written;
+        written = 0;
+      }
+    }
+  }
+  _pending.clear();
+}
+
+/**
+ *  Constructor. Create the directory of the resolved files.
+ *
+ *  The directory is private to this process.
+ */
+resolved_content::registry::registry()
+  : next_id(0) {
+  std::vector<char> buf(directory_template,
+                        directory_template + ::strlen(directory_template) + 1);
+  if (::mkdtemp(buf.data()))
+    directory = buf.data();
+  else {
+    char const* error = ::strerror(errno);
+    ERROR()
+      << "couldn't create the directory of the resolved files '"
+      << directory_template << "': " << error;
+  }
+}
+
+/**
+ *  Destructor. Remove the directory of the resolved files.
+ */
+resolved_content::registry::~registry() noexcept {
+  if (!directory.empty())
+    ::rmdir(directory.c_str());
+}
+
+/**
+ *  Get the registry of the stored contents.
+ *
+ *  @return  The registry.
+ */
+resolved_content::registry& resolved_content::_get_registry() {
+  static registry r;
+  return (r);
+}
@@ -33,7 +33,8 @@ sequence::sequence()
  */
 sequence::sequence(sequence&& seq) noexcept
   : _tasks(std::move(seq._tasks)),
-    _task_index(std::move(seq._task_index)) {}
+    _task_index(std::move(seq._task_index)),
+    _completed_tasks(std::move(seq._completed_tasks)) {}
 
 /**
  *  Move assignment operator.
@@ -46,6 +47,7 @@ sequence& sequence::operator=(sequence&& seq) noexcept {
   if (this != &seq) {
     _tasks = std::move(seq._tasks);
     _task_index = std::move(seq._task_index);
+    _completed_tasks = std::move(seq._completed_tasks);
   }
   return (*this);
 }
@@ -85,6 +87,46 @@ void sequence::reset() noexcept {
   _task_index = 0;
 }
 
+/**
+ *  Record the current task as completed.
+ */
+void sequence::checkpoint() {
+  _completed_tasks.push_back(_task_index);
+}
+
+/**
+ *  Move the sequence back to the task to resume from after the loss
+ *  of its instance.
+ *
+ *  The current task is unfinished. The sequence resumes at the closest
+ *  task, at or before it, that doesn't need the remote state of its
+ *  predecessors. Tasks that will be replayed lose their checkpoint.
+ *
+ *  @return  The index of the task to resume from.
+ */
+unsigned int sequence::resume() {
+  unsigned int index = _task_index;
+  if (index >= _tasks.size())
+    index = _tasks.empty() ? 0 : _tasks.size() - 1;
+  while (index > 0 && !_tasks[index].is_resumable())
+    --index;
+  while (!_completed_tasks.empty()
+         && _completed_tasks.back() >= index)
+    _completed_tasks.pop_back();
+  _task_index = index;
+  return (index);
+}
+
+/**
+ *  Get the completed tasks of the sequence.
+ *
+ *  @return  The indexes of the completed tasks, in order of completion.
+ */
+std::vector<unsigned int> const&
+  sequence::get_completed_tasks() const noexcept {
+  return (_completed_tasks);
+}
+
 /**
  *  Add a task to the sequence.
  *
@@ -93,3 +135,12 @@ void sequence::reset() noexcept {
 void sequence::add_task(task tsk) {
   _tasks.emplace_back(std::move(tsk));
 }
+
+/**
+ *  Get all the tasks of the sequence.
+ *
+ *  @return  The tasks, in order.
+ */
+std::vector<task> const& sequence::get_tasks() const noexcept {
+  return (_tasks);
+}
@@ -0,0 +1,104 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <utility>
+#include "com/centreon/cdash/spot_request.hh"
+#include "com/centreon/aws/ec2/command.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] profile      The profile.
+ *  @param[in] spec         The launch specification of the instances.
+ *  @param[in] count        The number of instances to request.
+ *  @param[in] price        The maximum price of an instance.
+ *  @param[in] valid_until  The end of validity of the request.
+ */
+spot_request::spot_request(
+                std::string profile,
+                aws::ec2::launch_specification spec,
+                unsigned int count,
+                double price,
+                timestamp valid_until)
+  : _profile(std::move(profile)),
+    _spec(std::move(spec)),
+    _count(count),
+    _price(price),
+    _valid_until(valid_until) {
+  set_auto_delete(false);
+}
+
+/**
+ *  Destructor.
+ */
+spot_request::~spot_request() noexcept {}
+
+/**
+ *  Request the spot instances.
+ *
+ *  Errors are stored instead of thrown, they are reported
+ *  by the owner of the request.
+ */
+void spot_request::run() {
+  try {
+    aws::ec2::command cmd(_profile);
+    _spot_instances = cmd.request_spot_instance(
+                            _price,
+                            _count,
+                            "persistent",
+                            timestamp(),
+                            _valid_until,
+                            _spec);
+    // The spot instances exceeding the count are cancelled by the owner.
+    if (_spot_instances.size() < _count)
+      _error = "requested " + std::to_string(_count)
+               + " spot instances, got "
+               + std::to_string(_spot_instances.size());
+  } catch (std::exception const& e) {
+    _error = e.what();
+  }
+}
+
+/**
+ *  Get the number of requested spot instances.
+ *
+ *  @return  The number of requested spot instances.
+ */
+unsigned int spot_request::get_count() const noexcept {
+  return (_count);
+}
+
+/**
+ *  Get the spot instances created by the request.
+ *
+ *  @return  The spot instances.
+ */
+std::vector<aws::ec2::spot_instance> const&
+  spot_request::get_spot_instances() const noexcept {
+  return (_spot_instances);
+}
+
+/**
+ *  Get the error of the request.
+ *
+ *  @return  The error, or an empty string if the request succeeded.
+ */
+std::string const& spot_request::get_error() const noexcept {
+  return (_error);
+}
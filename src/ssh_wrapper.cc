@@ -14,7 +14,15 @@
 ** limitations under the License.
 */
 
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
 #include "com/centreon/cdash/ssh_wrapper.hh"
+#include "com/centreon/cdash/log/error.hh"
 #include "com/centreon/exceptions/basic.hh"
 #include "com/centreon/misc/command_line_writer.hh"
 #include "com/centreon/process.hh"
@@ -35,8 +43,11 @@ ssh_wrapper::ssh_wrapper(
                std::string user)
   : _host(host),
     _port(port),
-    _user(user) {
-
+    _user(user),
+    _compression(false),
+    _control_path(_get_control_directory()) {
+  if (!_control_path.empty())
+    _control_path.append("/%r@%h:%p");
 }
 
 /**
@@ -47,7 +58,10 @@ ssh_wrapper::ssh_wrapper(
 ssh_wrapper::ssh_wrapper(ssh_wrapper const& other)
   : _host(other._host),
     _port(other._port),
-    _user(other._user) {
+    _user(other._user),
+    _cipher(other._cipher),
+    _compression(other._compression),
+    _control_path(other._control_path) {
 }
 
 /**
@@ -62,6 +76,9 @@ ssh_wrapper& ssh_wrapper::operator=(ssh_wrapper const& other) {
     _host = other._host;
     _port = other._port;
     _user = other._user;
+    _cipher = other._cipher;
+    _compression = other._compression;
+    _control_path = other._control_path;
   }
   return (*this);
 }
@@ -73,6 +90,51 @@ ssh_wrapper::~ssh_wrapper() {
 
 }
 
+/**
+ *  Set the cipher used by ssh.
+ *
+ *  @param[in] cipher  The cipher, or an empty string for the default one.
+ */
+void ssh_wrapper::set_cipher(std::string const& cipher) {
+  _cipher = cipher;
+}
+
+/**
+ *  Set if ssh compresses its connection.
+ *
+ *  @param[in] compression  True to compress.
+ */
+void ssh_wrapper::set_compression(bool compression) {
+  _compression = compression;
+}
+
+/**
+ *  Close the master connection to the distant server, if any.
+ *
+ *  The master connection is opened by the first ssh or scp run on the
+ *  distant server and shared by the next ones.
+ */
+void ssh_wrapper::close_master() {
+  if (_control_path.empty())
+    return ;
+  misc::command_line_writer writer("ssh -O exit");
+  writer.add_arg("-p", _port);
+  writer.add_arg("-o", std::string("ControlPath=") + _control_path);
+  std::string command = writer.get_command();
+  command.append(" ").append(_user).append("@").append(_host);
+
+  // There is nothing to close if no ssh was run since the last close.
+  process proc;
+  proc.enable_stream(process::in, false);
+  proc.enable_stream(process::out, false);
+  proc.enable_stream(process::err, false);
+  proc.exec(command);
+  if (!proc.wait(_close_master_timeout * 1000)) {
+    proc.kill();
+    proc.wait();
+  }
+}
+
 /**
  *  Copy a file to the distant server.
  *
@@ -88,20 +150,13 @@ void ssh_wrapper::copy_file(
                     std::string const& remote_filename,
                     std::string const& identity_fp,
                     unsigned int timeout) {
-  misc::command_line_writer writer("scp -oStrictHostKeyChecking=no");
-  writer.add_arg("-P", _port);
-  writer.add_arg_condition("-i", identity_fp, !identity_fp.empty());
-  writer.add_arg(
-    "-o",
-    std::string("ConnectTimeout=") + std::to_string(timeout));
-
-  std::string command = writer.get_command();
+  std::string command = _get_command("scp", "-P", identity_fp, timeout);
   command.append(" ").append(local_filename);
   command.append(" ").append(_user).append("@")
          .append(_host).append(":")
          .append(remote_filename);
 
-  proc.exec(command);
+  _exec(proc, command);
 }
 
 /**
@@ -119,20 +174,13 @@ void ssh_wrapper::copy_file_back(
                     std::string const& remote_filename,
                     std::string const& identity_fp,
                     unsigned int timeout) {
-  misc::command_line_writer writer("scp -oStrictHostKeyChecking=no");
-  writer.add_arg("-P", _port);
-  writer.add_arg_condition("-i", identity_fp, !identity_fp.empty());
-  writer.add_arg(
-    "-o",
-    std::string("ConnectTimeout=") + std::to_string(timeout));
-
-  std::string command = writer.get_command();
+  std::string command = _get_command("scp", "-P", identity_fp, timeout);
   command.append(" ").append(_user).append("@")
          .append(_host).append(":")
          .append(remote_filename);
   command.append(" ").append(local_filename);
 
-  proc.exec(command);
+  _exec(proc, command);
 }
 
 /**
@@ -148,17 +196,246 @@ void ssh_wrapper::execute(
                     std::string const& remote_cmd,
                     std::string const& identity_fp,
                     unsigned int timeout) {
-  misc::command_line_writer writer("ssh -oStrictHostKeyChecking=no");
-  writer.add_arg("-p", _port);
+  std::string command = _get_command("ssh", "-p", identity_fp, timeout);
+  command.append(" ").append(_user).append("@")
+         .append(_host).append(" ")
+         .append(remote_cmd);
+
+  _exec(proc, command);
+}
+
+/**
+ *  Create on the distant server a tar archive of several files,
+ *  written on the standard output of the process.
+ *
+ *
+ *  @param[in] process          Process used to create the archive.
+ *  @param[in] remote_filenames The remote files to archive.
+ *  @param[in] identity_fp      The path of the identity file.
+ *  @param[in] timeout          The timeout used to establish the connection.
+ */
+void ssh_wrapper::create_archive(
+                    process& proc,
+                    std::vector<std::string> const& remote_filenames,
+                    std::string const& identity_fp,
+                    unsigned int timeout) {
+  std::string remote_cmd("tar -cPf -");
+  for (auto const& remote_filename : remote_filenames)
+    remote_cmd.append(" ").append(_quote(remote_filename));
+  std::string command = _get_command("ssh", "-p", identity_fp, timeout);
+  command.append(" ").append(_user).append("@")
+         .append(_host).append(" ")
+         .append(_protect(remote_cmd));
+
+  _exec(proc, command);
+}
+
+/**
+ *  Extract on the distant server the tar archive written
+ *  on the standard input of the process.
+ *
+ *  Missing directories are created by tar.
+ *
+ *  @param[in] process     Process used to extract the archive.
+ *  @param[in] identity_fp The path of the identity file.
+ *  @param[in] timeout     The timeout used to establish the connection.
+ */
+void ssh_wrapper::extract_archive(
+                    process& proc,
+                    std::string const& identity_fp,
+                    unsigned int timeout) {
+  std::string command = _get_command("ssh", "-p", identity_fp, timeout);
+  command.append(" ").append(_user).append("@")
+         .append(_host).append(" ")
+         .append("tar -xPf -");
+
+  _exec(proc, command);
+}
+
+/**
+ *  Write on the distant server a file whose size, on its own line,
+ *  then content are written on the standard input of the process.
+ *
+ *  The content is written to a temporary file, moved in place only
+ *  once complete.
+ *
+ *  @param[in] process          Process used to write the file.
+ *  @param[in] remote_filename  The remote filename of the file.
+ *  @param[in] mode             The permissions of the file.
+ *  @param[in] identity_fp      The path of the identity file.
+ *  @param[in] timeout          The timeout used to establish the connection.
+ */
+void ssh_wrapper::write_file(
+                    process& proc,
+                    std::string const& remote_filename,
+                    unsigned int mode,
+                    std::string const& identity_fp,
+                    unsigned int timeout) {
+  char mode_str[8];
+  ::snprintf(mode_str, sizeof(mode_str), "%04o", mode & 07777);
+  std::string path(_quote(remote_filename));
+  std::string tmp(_quote(remote_filename + ".cdash-tmp"));
+  // The size comes first, on its own line. The file is moved in place
+  // only once it is complete.
+  std::string remote_cmd("read -r size && head -c \"$size\" > ");
+  remote_cmd.append(tmp)
+            .append(" && [ \"$(wc -c < ").append(tmp)
+            .append(")\" -eq \"$size\" ] && chmod ").append(mode_str)
+            .append(" ").append(tmp)
+            .append(" && mv -f ").append(tmp).append(" ").append(path)
+            .append(" || { rm -f ").append(tmp).append("; exit 1; }");
+  std::string command = _get_command("ssh", "-p", identity_fp, timeout);
+  command.append(" ").append(_user).append("@")
+         .append(_host).append(" ")
+         .append(_protect(remote_cmd));
+
+  _exec(proc, command);
+}
+
+/**
+ *  Get the command line of ssh or scp, with the options shared by all
+ *  the commands run on the distant server.
+ *
+ *  @param[in] program      'ssh' or 'scp'.
+ *  @param[in] port_option  The option setting the port of the program.
+ *  @param[in] identity_fp  The path of the identity file.
+ *  @param[in] timeout      The timeout used to establish the connection.
+ *
+ *  @return  The command line, without the distant server.
+ */
+std::string ssh_wrapper::_get_command(
+                           std::string const& program,
+                           std::string const& port_option,
+                           std::string const& identity_fp,
+                           unsigned int timeout) const {
+  std::string base(program);
+  if (_compression)
+    base.append(" -C");
+  base.append(" -oStrictHostKeyChecking=no");
+  misc::command_line_writer writer(base);
+  writer.add_arg(port_option, _port);
   writer.add_arg_condition("-i", identity_fp, !identity_fp.empty());
+  writer.add_arg_condition("-c", _cipher, !_cipher.empty());
   writer.add_arg(
     "-o",
     std::string("ConnectTimeout=") + std::to_string(timeout));
+  if (!_control_path.empty()) {
+    // Share one connection between all the commands run on the server.
+    writer.add_arg("-o", std::string("ControlMaster=auto"));
+    writer.add_arg("-o", std::string("ControlPath=") + _control_path);
+    writer.add_arg(
+      "-o",
+      std::string("ControlPersist=")
+      + std::to_string(_control_persist_duration));
+  }
+  return (writer.get_command());
+}
 
-  std::string command = writer.get_command();
-  command.append(" ").append(_user).append("@")
-         .append(_host).append(" ")
-         .append(remote_cmd);
+/**
+ *  Get the directory of the master connection sockets, creating it
+ *  if needed.
+ *
+ *  @return  The directory, or an empty string if it is unusable and
+ *           connections should not be shared.
+ */
+std::string const& ssh_wrapper::_get_control_directory() {
+  static std::string const directory(_create_control_directory());
+  return (directory);
+}
+
+/**
+ *  Create the directory of the master connection sockets.
+ *
+ *  It lives under $XDG_RUNTIME_DIR, or under /tmp. It must only be
+ *  accessible to us, as anyone able to use a socket can run commands
+ *  on the distant servers.
+ *
+ *  @return  The directory, or an empty string if it is unusable.
+ */
+std::string ssh_wrapper::_create_control_directory() {
+  std::string directory;
+  char const* runtime_dir = ::getenv("XDG_RUNTIME_DIR");
+  if (runtime_dir && *runtime_dir)
+    directory.append(runtime_dir).append("/cdash");
+  else
+    directory.append("/tmp/cdash-").append(std::to_string(::getuid()));
 
+  struct stat st;
+  if (::mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+    char const* error = ::strerror(errno);
+    ERROR()
+      << "couldn't create ssh control directory '" << directory
+      << "', ssh connections won't be shared: " << error;
+    return (std::string());
+  }
+  if (::lstat(directory.c_str(), &st) != 0
+      || !S_ISDIR(st.st_mode)
+      || st.st_uid != ::getuid()
+      || (st.st_mode & 077)) {
+    ERROR()
+      << "ssh control directory '" << directory
+      << "' is not a private directory, ssh connections won't be shared";
+    return (std::string());
+  }
+  return (directory);
+}
+
+/**
+ *  Execute a command, with its standard input open.
+ *
+ *  @param[in] proc     The process.
+ *  @param[in] command  The command.
+ */
+void ssh_wrapper::_exec(process& proc, std::string const& command) {
+  // The standard input is closed at the end of an archive transfer.
+  proc.enable_stream(process::in, true);
   proc.exec(command);
 }
+
+/**
+ *  Quote a string for the distant shell.
+ *
+ *  A leading '~/' is left out of the quotes, to be expanded.
+ *
+ *  @param[in] str  The string, usually a remote filename.
+ *
+ *  @return  The quoted string.
+ */
+std::string ssh_wrapper::_quote(std::string const& str) {
+  std::string quoted;
+  size_t start = 0;
+  if (str.compare(0, 2, "~/") == 0) {
+    quoted.append("~/");
+    start = 2;
+  }
+  quoted.append("'");
+  for (size_t i = start; i < str.size(); ++i)
+    if (str[i] == '\'')
+      quoted.append("'\\''");
+    else
+      quoted.push_back(str[i]);
+  quoted.append("'");
+  return (quoted);
+}
+
+/**
+ *  Protect a command run on the distant server from the local parsing
+ *  of the command line, so that ssh gets it as one argument, as is.
+ *
+ *  The command line is split like a shell does: the command is put
+ *  between double quotes, and the characters special there escaped.
+ *
+ *  @param[in] remote_cmd  The command to run on the distant server.
+ *
+ *  @return  The protected command.
+ */
+std::string ssh_wrapper::_protect(std::string const& remote_cmd) {
+  std::string protected_cmd("\"");
+  for (auto c : remote_cmd) {
+    if (c == '"' || c == '\\' || c == '$' || c == '`')
+      protected_cmd.push_back('\\');
+    protected_cmd.push_back(c);
+  }
+  protected_cmd.push_back('"');
+  return (protected_cmd);
+}
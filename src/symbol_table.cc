@@ -0,0 +1,271 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <cstring>
+#include "com/centreon/concurrency/locker.hh"
+#include "com/centreon/cdash/digest.hh"
+#include "com/centreon/cdash/symbol_table.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+constexpr symbol_table::symbol symbol_table::empty;
+constexpr symbol_table::symbol symbol_table::not_found;
+constexpr size_t symbol_table::_first_block_size;
+constexpr unsigned int symbol_table::_max_blocks;
+
+/**
+ *  Intern a string.
+ *
+ *  @param[in] str  The string.
+ *
+ *  @return  The symbol of the string.
+ */
+symbol_table::symbol symbol_table::intern(std::string const& str) {
+  symbol_table& table = _instance();
+  concurrency::locker lock(&table._mut);
+  return (table._intern(str.data(), str.size()));
+}
+
+/**
+ *  Intern a string, without copying it when it's already interned.
+ *
+ *  @param[in] data  The string.
+ *  @param[in] size  The size of the string.
+ *
+ *  @return  The symbol of the string.
+ */
+symbol_table::symbol symbol_table::intern(char const* data, size_t size) {
+  symbol_table& table = _instance();
+  concurrency::locker lock(&table._mut);
+  return (table._intern(data, size));
+}
+
+/**
+ *  Intern the qualified name of a macro, 'type.name'.
+ *
+ *  The qualified names are cached: no string is built when the
+ *  qualified name was already interned.
+ *
+ *  @param[in] type  The symbol of the type.
+ *  @param[in] name  The symbol of the name.
+ *
+ *  @return  The symbol of 'type.name'.
+ */
+symbol_table::symbol symbol_table::intern_qualified(
+                                     symbol type,
+                                     symbol name) {
+  symbol_table& table = _instance();
+  concurrency::locker lock(&table._mut);
+  std::pair<symbol, symbol> key(type, name);
+  auto found = table._qualified.find(key);
+  if (found != table._qualified.end())
+    return (found->second);
+  std::string qualified(table._at(type) + "." + table._at(name));
+  symbol sym = table._intern(qualified.data(), qualified.size());
+  // XXX: No emplace because GCC 4.7.
+  table._qualified.insert(std::make_pair(key, sym));
+  table._splits.insert(std::make_pair(sym, key));
+  return (sym);
+}
+
+/**
+ *  Find the symbol of a string, without interning it.
+ *
+ *  @param[in] str  The string.
+ *
+ *  @return  The symbol of the string, or not_found.
+ */
+symbol_table::symbol symbol_table::find(std::string const& str) noexcept {
+  return (find(str.data(), str.size()));
+}
+
+/**
+ *  Find the symbol of a string, without interning nor copying it.
+ *
+ *  @param[in] data  The string.
+ *  @param[in] size  The size of the string.
+ *
+ *  @return  The symbol of the string, or not_found.
+ */
+symbol_table::symbol symbol_table::find(
+                                     char const* data,
+                                     size_t size) noexcept {
+  symbol_table& table = _instance();
+  concurrency::locker lock(&table._mut);
+  key k = { data, size };
+  auto found = table._symbols.find(k);
+  return (found != table._symbols.end() ? found->second : not_found);
+}
+
+/**
+ *  Split a qualified name, 'type.name', at its first dot.
+ *
+ *  @param[in]  sym   The symbol of the qualified name.
+ *  @param[out] type  The symbol of the type.
+ *  @param[out] name  The symbol of the name.
+ *
+ *  @return  False if the string isn't a qualified name, or if its type
+ *           or name were never interned.
+ */
+bool symbol_table::split_qualified(
+                     symbol sym,
+                     symbol& type,
+                     symbol& name) noexcept {
+  symbol_table& table = _instance();
+  concurrency::locker lock(&table._mut);
+  auto found = table._splits.find(sym);
+  if (found == table._splits.end()) {
+    std::string const& str = table._at(sym);
+    size_t dot = str.find('.');
+    if (dot == std::string::npos) {
+      // XXX: No emplace because GCC 4.7.
+      table._splits.insert(
+        std::make_pair(sym, std::make_pair(not_found, not_found)));
+      return (false);
+    }
+    key type_key = { str.data(), dot };
+    key name_key = { str.data() + dot + 1, str.size() - dot - 1 };
+    auto found_type = table._symbols.find(type_key);
+    auto found_name = table._symbols.find(name_key);
+    // Not cached: the type or the name may be interned later.
+    if (found_type == table._symbols.end()
+        || found_name == table._symbols.end())
+      return (false);
+    std::pair<symbol, symbol> split(found_type->second, found_name->second);
+    // XXX: No emplace because GCC 4.7.
+    found = table._splits.insert(std::make_pair(sym, split)).first;
+  }
+  if (found->second.first == not_found)
+    return (false);
+  type = found->second.first;
+  name = found->second.second;
+  return (true);
+}
+
+/**
+ *  Get the string of a symbol.
+ *
+ *  @param[in] sym  The symbol.
+ *
+ *  @return  The string. It lives as long as the program.
+ */
+std::string const& symbol_table::get(symbol sym) noexcept {
+  return (_instance()._at(sym));
+}
+
+/**
+ *  Constructor.
+ */
+symbol_table::symbol_table() : _size(0) {
+  for (auto& block : _blocks)
+    block.store(nullptr, std::memory_order_relaxed);
+  _intern("", 0);
+}
+
+/**
+ *  Destructor.
+ */
+symbol_table::~symbol_table() noexcept {
+  for (auto& block : _blocks)
+    delete [] block.load(std::memory_order_relaxed);
+}
+
+/**
+ *  Get the symbol table.
+ *
+ *  @return  The symbol table.
+ */
+symbol_table& symbol_table::_instance() {
+  static symbol_table table;
+  return (table);
+}
+
+/**
+ *  Get the string of a symbol, without the lock.
+ *
+ *  Block n holds the symbols from _first_block_size * (2^n - 1).
+ *
+ *  @param[in] sym  The symbol, already interned.
+ *
+ *  @return  The string.
+ */
+std::string& symbol_table::_at(symbol sym) const noexcept {
+  unsigned long long index = sym + _first_block_size;
+  unsigned int block = (63 - __builtin_clzll(index))
+                       - (63 - __builtin_clzll(_first_block_size));
+  return (_blocks[block].load(std::memory_order_acquire)
+            [index - (_first_block_size << block)]);
+}
+
+/**
+ *  Intern a string. The lock must be held.
+ *
+ *  @param[in] data  The string.
+ *  @param[in] size  The size of the string.
+ *
+ *  @return  The symbol of the string.
+ */
+symbol_table::symbol symbol_table::_intern(char const* data, size_t size) {
+  key k = { data, size };
+  auto found = _symbols.find(k);
+  if (found != _symbols.end())
+    return (found->second);
+  symbol sym = _size;
+  unsigned long long index = sym + _first_block_size;
+  // The first symbol of a block: add the block.
+  if ((index & (index - 1)) == 0) {
+    unsigned int block = (63 - __builtin_clzll(index))
+                         - (63 - __builtin_clzll(_first_block_size));
+    _blocks[block].store(
+      new std::string[_first_block_size << block],
+      std::memory_order_release);
+  }
+  std::string& str = _at(sym);
+  str.assign(data, size);
+  ++_size;
+  k.data = str.data();
+  // XXX: No emplace because GCC 4.7.
+  _symbols.insert(std::make_pair(k, sym));
+  return (sym);
+}
+
+/**
+ *  Hash a string.
+ *
+ *  @param[in] k  The string.
+ *
+ *  @return  The hash of the string.
+ */
+size_t symbol_table::key_hash::operator()(key const& k) const noexcept {
+  digest dig;
+  dig.update(k.data, k.size);
+  return (static_cast<size_t>(dig.get_value()));
+}
+
+/**
+ *  Compare two strings.
+ *
+ *  @param[in] a  The first string.
+ *  @param[in] b  The second string.
+ *
+ *  @return  True if both strings are equal.
+ */
+bool symbol_table::key_equal::operator()(
+                                key const& a,
+                                key const& b) const noexcept {
+  return (a.size == b.size && ::memcmp(a.data, b.data, a.size) == 0);
+}
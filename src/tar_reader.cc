@@ -0,0 +1,290 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "com/centreon/cdash/tar_reader.hh"
+#include "com/centreon/exceptions/basic.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+// Size of a tar block.
+static unsigned int const block_size = 512;
+
+/**
+ *  Parse a numeric field of a tar header.
+ *
+ *  @param[in] field  The field.
+ *  @param[in] size   The size of the field.
+ *
+ *  @return           The value of the field.
+ */
+static unsigned long long parse_number(char const* field, size_t size) {
+  unsigned long long value = 0;
+  // Base-256 encoding, for big values.
+  if (static_cast<unsigned char>(field[0]) & 0x80) {
+    value = static_cast<unsigned char>(field[0]) & 0x7f;
+    for (size_t i = 1; i < size; ++i)
+      value = (value << 8) | static_cast<unsigned char>(field[i]);
+    return (value);
+  }
+  for (size_t i = 0; i < size; ++i) {
+    if (field[i] >= '0' && field[i] <= '7')
+      value = (value << 3) | (field[i] - '0');
+    else if (field[i] != ' ' || value != 0)
+      break ;
+  }
+  return (value);
+}
+
+/**
+ *  Constructor.
+ */
+tar_reader::tar_reader()
+  : _state(header),
+    _left(0),
+    _padding(0),
+    _fd(-1) {}
+
+/**
+ *  Destructor.
+ */
+tar_reader::~tar_reader() noexcept {
+  _close();
+}
+
+/**
+ *  Expect a file in the archive.
+ *
+ *  @param[in] name            The name of the file in the archive.
+ *  @param[in] local_filename  Where to extract the file.
+ */
+void tar_reader::add_file(
+                   std::string const& name,
+                   std::string const& local_filename) {
+  _expected[name] = local_filename;
+}
+
+/**
+ *  Feed a chunk of the archive.
+ *
+ *  @param[in] data  The chunk.
+ *  @param[in] size  The size of the chunk.
+ */
+void tar_reader::feed(char const* data, size_t size) {
+  while (size > 0 && _state != end) {
+    if (_state == header) {
+      size_t len = std::min(size, block_size - _buffer.size());
+      _buffer.append(data, len);
+      data += len;
+      size -= len;
+      if (_buffer.size() == block_size) {
+        _parse_header();
+        _buffer.clear();
+      }
+    }
+    else if (_state == padding) {
+      size_t len = std::min<unsigned long long>(size, _padding);
+      data += len;
+      size -= len;
+      _padding -= len;
+      if (_padding == 0)
+        _state = header;
+    }
+    else {
+      size_t len = std::min<unsigned long long>(size, _left);
+      if (_state == content && _fd != -1) {
+        char const* ptr = data;
+        size_t remaining = len;
+        while (remaining > 0) {
+          ssize_t wb = ::write(_fd, ptr, remaining);
+          if (wb < 0 && errno == EINTR)
+            continue ;
+          if (wb < 0) {
+            char const* error = ::strerror(errno);
+            throw (exceptions::basic()
+                   << "tar_reader: couldn't write '"
+                   << _expected[_current_name] << "': " << error);
+          }
+          ptr += wb;
+          remaining -= wb;
+        }
+        _extracted[_current_name] += len;
+      }
+      else if (_state == long_name || _state == pax_header)
+        _buffer.append(data, len);
+      data += len;
+      size -= len;
+      _left -= len;
+      if (_left == 0) {
+        if (_state == long_name)
+          _next_name = _buffer.c_str();
+        else if (_state == pax_header)
+          _parse_pax_header();
+        _buffer.clear();
+        _close();
+        _state = (_padding ? padding : header);
+      }
+    }
+  }
+}
+
+/**
+ *  Check that the archive is complete and close the last file.
+ */
+void tar_reader::finish() {
+  _close();
+  if (_state != end && !(_state == header && _buffer.empty()))
+    throw (exceptions::basic()
+           << "tar_reader: the archive is truncated");
+  for (auto const& expected : _expected)
+    if (_extracted.find(expected.first) == _extracted.end())
+      throw (exceptions::basic()
+             << "tar_reader: file '" << expected.first
+             << "' is missing from the archive");
+}
+
+/**
+ *  Get the extracted files and their sizes.
+ *
+ *  @return  The size of each extracted file, by name in the archive.
+ */
+std::map<std::string, unsigned long long> const&
+  tar_reader::get_extracted_files() const noexcept {
+  return (_extracted);
+}
+
+/**
+ *  Parse an entry header.
+ */
+void tar_reader::_parse_header() {
+  char const* hdr = _buffer.data();
+
+  // Two zero blocks end the archive. One is enough to stop reading.
+  if (std::count(hdr, hdr + block_size, '\0') == block_size) {
+    _state = end;
+    return ;
+  }
+
+  unsigned int checksum = 0;
+  for (unsigned int i = 0; i < block_size; ++i)
+    checksum += (i >= 148 && i < 156)
+                  ? ' '
+                  : static_cast<unsigned char>(hdr[i]);
+  if (checksum != parse_number(hdr + 148, 8))
+    throw (exceptions::basic()
+           << "tar_reader: invalid header checksum");
+
+  unsigned long long size = parse_number(hdr + 124, 12);
+  char type = hdr[156];
+  std::string name;
+  if (!_next_name.empty()) {
+    name = _next_name;
+    _next_name.clear();
+  }
+  else {
+    std::string prefix(hdr + 345, ::strnlen(hdr + 345, 155));
+    if (!prefix.empty() && ::memcmp(hdr + 257, "ustar", 5) == 0)
+      name = prefix + "/";
+    name.append(hdr, ::strnlen(hdr, 100));
+  }
+
+  if (type == 'L')
+    _start_content(long_name, size);
+  else if (type == 'x')
+    _start_content(pax_header, size);
+  else {
+    if ((type == '0' || type == '\0')
+        && _expected.find(name) != _expected.end()) {
+      _current_name = name;
+      _open(_expected[name], parse_number(hdr + 100, 8));
+    }
+    // Directories, links and global headers have no content to extract.
+    _start_content(content, (type == '0' || type == '\0' || type == 'g'
+                             || type == '7') ? size : 0);
+  }
+}
+
+/**
+ *  Parse the records of a pax header to find the path of the next entry.
+ */
+void tar_reader::_parse_pax_header() {
+  size_t pos = 0;
+  while (pos < _buffer.size()) {
+    // Records are "<length> <key>=<value>\n".
+    size_t space = _buffer.find(' ', pos);
+    if (space == std::string::npos)
+      break ;
+    size_t length = std::strtoul(_buffer.c_str() + pos, nullptr, 10);
+    if (length == 0 || pos + length > _buffer.size())
+      break ;
+    std::string record(_buffer, space + 1, pos + length - space - 2);
+    if (record.compare(0, 5, "path=") == 0)
+      _next_name = record.substr(5);
+    pos += length;
+  }
+}
+
+/**
+ *  Open a local file for extraction.
+ *
+ *  @param[in] name  The local filename.
+ *  @param[in] mode  The permissions of the file.
+ */
+void tar_reader::_open(std::string const& name, unsigned int mode) {
+  _close();
+  _fd = ::open(
+          name.c_str(),
+          O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+          (mode & 0777) ? (mode & 0777) : 0644);
+  if (_fd == -1) {
+    char const* error = ::strerror(errno);
+    throw (exceptions::basic()
+           << "tar_reader: couldn't create '" << name << "': " << error);
+  }
+  _extracted[_current_name] = 0;
+}
+
+/**
+ *  Close the file being extracted.
+ */
+void tar_reader::_close() noexcept {
+  if (_fd != -1)
+    ::close(_fd);
+  _fd = -1;
+}
+
+/**
+ *  Start reading the content of an entry.
+ *
+ *  @param[in] st    The content state.
+ *  @param[in] size  The size of the content.
+ */
+void tar_reader::_start_content(state st, unsigned long long size) {
+  _left = size;
+  _padding = (block_size - size % block_size) % block_size;
+  if (size)
+    _state = st;
+  else {
+    _close();
+    _state = header;
+  }
+}
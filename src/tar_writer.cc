@@ -0,0 +1,199 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "com/centreon/cdash/tar_writer.hh"
+#include "com/centreon/exceptions/basic.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+// Size of a tar block.
+static unsigned int const block_size = 512;
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] proc  The process receiving the archive on its standard input.
+ */
+tar_writer::tar_writer(process& proc)
+  : _proc(proc),
+    _size(0) {}
+
+/**
+ *  Destructor.
+ */
+tar_writer::~tar_writer() noexcept {}
+
+/**
+ *  Add a local file to the archive.
+ *
+ *  @param[in] name            The name of the file in the archive.
+ *  @param[in] local_filename  The file to read the content from.
+ *  @param[in] mode            The permissions of the file in the archive.
+ */
+void tar_writer::add_file(
+                   std::string const& name,
+                   std::string const& local_filename,
+                   unsigned int mode) {
+  int fd = ::open(local_filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    char const* error = ::strerror(errno);
+    throw (exceptions::basic()
+           << "tar_writer: couldn't open '" << local_filename
+           << "': " << error);
+  }
+  try {
+    struct stat st;
+    if (::fstat(fd, &st) == -1) {
+      char const* error = ::strerror(errno);
+      throw (exceptions::basic()
+             << "tar_writer: couldn't stat '" << local_filename
+             << "': " << error);
+    }
+    _write_header(name, '0', st.st_size, mode, st.st_mtime);
+
+    char buffer[64 * 1024];
+    unsigned long long left = st.st_size;
+    while (left > 0) {
+      ssize_t rb = ::read(fd, buffer, sizeof(buffer));
+      if (rb < 0 && errno == EINTR)
+        continue ;
+      if (rb <= 0)
+        throw (exceptions::basic()
+               << "tar_writer: couldn't read '" << local_filename
+               << "': " << (rb < 0 ? ::strerror(errno) : "file truncated"));
+      if (static_cast<unsigned long long>(rb) > left)
+        rb = left;
+      _write(buffer, rb);
+      left -= rb;
+    }
+    _pad(st.st_size);
+  } catch (...) {
+    ::close(fd);
+    throw ;
+  }
+  ::close(fd);
+}
+
+/**
+ *  Write the end of archive marker.
+ */
+void tar_writer::finish() {
+  char zero[block_size * 2];
+  ::memset(zero, 0, sizeof(zero));
+  _write(zero, sizeof(zero));
+}
+
+/**
+ *  Get the number of bytes written so far.
+ *
+ *  @return  The size of the archive.
+ */
+unsigned long long tar_writer::get_size() const noexcept {
+  return (_size);
+}
+
+/**
+ *  Write an entry header.
+ *
+ *  Names too long for the ustar header use a GNU long name entry,
+ *  understood by GNU tar and bsdtar.
+ *
+ *  @param[in] name   The name of the entry.
+ *  @param[in] type   The type flag of the entry.
+ *  @param[in] size   The size of the entry content.
+ *  @param[in] mode   The permissions of the entry.
+ *  @param[in] mtime  The modification time of the entry.
+ */
+void tar_writer::_write_header(
+                   std::string const& name,
+                   char type,
+                   unsigned long long size,
+                   unsigned int mode,
+                   long mtime) {
+  if (name.size() >= 100) {
+    _write_header("././@LongLink", 'L', name.size() + 1, 0644, 0);
+    _write(name.c_str(), name.size() + 1);
+    _pad(name.size() + 1);
+  }
+
+  char header[block_size];
+  ::memset(header, 0, sizeof(header));
+  ::strncpy(header, name.c_str(), 99);
+  ::snprintf(header + 100, 8, "%07o", mode & 07777);
+  ::snprintf(header + 108, 8, "%07o", 0);
+  ::snprintf(header + 116, 8, "%07o", 0);
+  // Sizes of 8 GiB or more don't fit in octal: use base-256.
+  if (size > 077777777777ull) {
+    header[124] = static_cast<char>(0x80);
+    unsigned long long left = size;
+    for (int i = 135; i > 124; --i, left >>= 8)
+      header[i] = static_cast<char>(left & 0xff);
+  }
+  else
+    ::snprintf(header + 124, 12, "%011llo", size);
+  ::snprintf(header + 136, 12, "%011lo", static_cast<unsigned long>(mtime));
+  header[156] = type;
+  ::memcpy(header + 257, "ustar", 6);
+  ::memcpy(header + 263, "00", 2);
+
+  // The checksum is computed with its own field filled with spaces.
+  ::memset(header + 148, ' ', 8);
+  unsigned int checksum = 0;
+  for (unsigned int i = 0; i < block_size; ++i)
+    checksum += static_cast<unsigned char>(header[i]);
+  ::snprintf(header + 148, 8, "%06o", checksum);
+  _write(header, sizeof(header));
+}
+
+/**
+ *  Write data on the standard input of the process.
+ *
+ *  @param[in] data  The data.
+ *  @param[in] size  The size of the data.
+ */
+void tar_writer::_write(void const* data, size_t size) {
+  char const* ptr = static_cast<char const*>(data);
+  while (size > 0) {
+    unsigned int wb = _proc.write(ptr, size);
+    if (wb == 0)
+      throw (exceptions::basic()
+             << "tar_writer: couldn't write the archive");
+    ptr += wb;
+    size -= wb;
+    _size += wb;
+  }
+}
+
+/**
+ *  Pad an entry content to a multiple of the block size.
+ *
+ *  @param[in] size  The size of the entry content.
+ */
+void tar_writer::_pad(unsigned long long size) {
+  char zero[block_size];
+  unsigned int left = (block_size - size % block_size) % block_size;
+  if (left) {
+    ::memset(zero, 0, left);
+    _write(zero, left);
+  }
+}
@@ -14,23 +14,66 @@
 ** limitations under the License.
 */
 
+#include "com/centreon/cdash/log/error.hh"
 #include "com/centreon/cdash/task.hh"
 #include "com/centreon/exceptions/basic.hh"
 
 using namespace com::centreon;
 using namespace com::centreon::cdash;
 
+// Symbols of the macros used by tasks.
+static symbol_table::symbol const ami_macro
+  = symbol_table::intern("ami");
+static symbol_table::symbol const command_macro
+  = symbol_table::intern("command");
+static symbol_table::symbol const file_transport_macro
+  = symbol_table::intern("file_transport");
+static symbol_table::symbol const instance_linger_time_macro
+  = symbol_table::intern("instance_linger_time");
+static symbol_table::symbol const key_macro
+  = symbol_table::intern("key");
+static symbol_table::symbol const key_file_macro
+  = symbol_table::intern("key_file");
+static symbol_table::symbol const resumable_macro
+  = symbol_table::intern("resumable");
+static symbol_table::symbol const security_group_macro
+  = symbol_table::intern("security_group");
+static symbol_table::symbol const security_group_id_macro
+  = symbol_table::intern("security_group_id");
+static symbol_table::symbol const should_delete_macro
+  = symbol_table::intern("should_delete");
+static symbol_table::symbol const slots_macro
+  = symbol_table::intern("slots");
+static symbol_table::symbol const ssh_cipher_macro
+  = symbol_table::intern("ssh_cipher");
+static symbol_table::symbol const ssh_compression_macro
+  = symbol_table::intern("ssh_compression");
+static symbol_table::symbol const ssh_port_macro
+  = symbol_table::intern("ssh_port");
+static symbol_table::symbol const ssh_timeout_macro
+  = symbol_table::intern("ssh_timeout");
+static symbol_table::symbol const ssh_user_macro
+  = symbol_table::intern("ssh_user");
+static symbol_table::symbol const subnet_id_macro
+  = symbol_table::intern("subnet_id");
+static symbol_table::symbol const type_macro
+  = symbol_table::intern("type");
+
 /**
  *  Constructor.
  *
- *  @param[in] obj  The object of this task.
+ *  @param[in] obj                  The object of this task.
+ *  @param[in] resolve_file_macros  False if the macros of the files are
+ *                                  already resolved, by the
+ *                                  configuration cache.
  */
-task::task(object obj)
+task::task(object obj, bool resolve_file_macros)
   : _obj(std::move(obj)) {
   // Validate the task.
   _validate();
   // Resolve macro from files.
-  _resolve_file_macros();
+  if (resolve_file_macros)
+    _resolve_file_macros();
 }
 
 /**
@@ -60,8 +103,8 @@ task& task::operator=(task&& tsk) noexcept {
  *
  *  @return  The ami of this task.
  */
-std::string task::get_ami() const {
-  return (_obj.macro_content("ami"));
+std::string const& task::get_ami() const {
+  return (_obj.macro_content(ami_macro));
 }
 
 /**
@@ -69,8 +112,8 @@ std::string task::get_ami() const {
  *
  *  @return  The amazon instance type of this task.
  */
-std::string task::get_amazon_instance_type() const {
-  return (_obj.macro_content("type"));
+std::string const& task::get_amazon_instance_type() const {
+  return (_obj.macro_content(type_macro));
 }
 
 /**
@@ -96,8 +139,8 @@ std::vector<file> const& task::get_returned_files() const noexcept {
  *
  *  @return  The command.
  */
-std::string task::get_command() const {
-  return (_obj.macro_content("command"));
+std::string const& task::get_command() const {
+  return (_obj.macro_content(command_macro));
 }
 
 /**
@@ -114,8 +157,8 @@ std::string task::get_name() const {
  *
  *  @return  The key name.
  */
-std::string task::get_key_name() const {
-  return (_obj.macro_content("key"));
+std::string const& task::get_key_name() const {
+  return (_obj.macro_content(key_macro));
 }
 
 /**
@@ -123,8 +166,8 @@ std::string task::get_key_name() const {
  *
  *  @return  The key filename.
  */
-std::string task::get_key_file() const {
-  return (_obj.macro_content("key_file"));
+std::string const& task::get_key_file() const {
+  return (_obj.macro_content(key_file_macro));
 }
 
 /**
@@ -132,8 +175,8 @@ std::string task::get_key_file() const {
  *
  *  @return  The security group.
  */
-std::string task::get_security_group() const {
-  return (_obj.macro_content("security_group"));
+std::string const& task::get_security_group() const {
+  return (_obj.macro_content(security_group_macro));
 }
 
 /**
@@ -141,8 +184,8 @@ std::string task::get_security_group() const {
  *
  *  @return  The security group id.
  */
-std::string task::get_security_group_id() const {
-  return (_obj.macro_content("security_group_id"));
+std::string const& task::get_security_group_id() const {
+  return (_obj.macro_content(security_group_id_macro));
 }
 
 /**
@@ -151,7 +194,7 @@ std::string task::get_security_group_id() const {
  *  @return  The ssh timeout.
  */
 unsigned int task::get_ssh_timeout() const {
-  std::string timeout_str = _obj.macro_content("ssh_timeout");
+  std::string const& timeout_str = _obj.macro_content(ssh_timeout_macro);
   int timeout = 0;
   try {
    timeout = std::stoi(timeout_str);
@@ -162,10 +205,81 @@ unsigned int task::get_ssh_timeout() const {
 /**
  *  True if the instance should be deleted at the end of the task.
  *
- *  @return  True if the instance should be deleted at the end of the task.
+ *  Called from the manager loop: macro errors are reported, not thrown.
+ *
+ *  @return  True if the instance should be deleted at the end of the
+ *           task, default true.
  */
 bool task::should_be_deleted() const noexcept {
-  return (_obj.macro_content("should_delete") != "false");
+  try {
+    return (_obj.macro_content(should_delete_macro) != "false");
+  } catch (std::exception const& e) {
+    ERROR(_obj.get_name())
+      << "couldn't resolve macro 'should_delete', deleting the instance: "
+      << e.what();
+  }
+  return (true);
+}
+
+/**
+ *  True if the task can run on a fresh instance, without the remote state
+ *  left by the previous tasks of its sequence.
+ *
+ *  Called from the manager loop: macro errors are reported, not thrown.
+ *
+ *  @return  True if the task is resumable, default false.
+ */
+bool task::is_resumable() const noexcept {
+  try {
+    return (_obj.macro_content(resumable_macro) == "true");
+  } catch (std::exception const& e) {
+    ERROR(_obj.get_name())
+      << "couldn't resolve macro 'resumable', replaying the task: "
+      << e.what();
+  }
+  return (false);
+}
+
+/**
+ *  Get how long the instance stays idle, waiting for another sequence
+ *  with the same launch specification, once its sequence is finished.
+ *
+ *  @return  The linger time in seconds, default 0.
+ */
+unsigned int task::get_instance_linger_time() const {
+  std::string const& linger_str = _obj.macro_content(instance_linger_time_macro);
+  int linger = 0;
+  try {
+    linger = std::stoi(linger_str);
+  } catch (...) {}
+  return (linger > 0 ? linger : 0);
+}
+
+/**
+ *  Get the number of sequences an instance of this task can run
+ *  concurrently.
+ *
+ *  @return  The number of slots, default 1.
+ */
+unsigned int task::get_slots() const {
+  std::string const& slots_str = _obj.macro_content(slots_macro);
+  int slots = 0;
+  try {
+    slots = std::stoi(slots_str);
+  } catch (...) {}
+  return (slots > 0 ? slots : 1);
+}
+
+/**
+ *  Get how the files are copied to the remote server.
+ *
+ *  @return  'scp' (default) to copy each file with scp, 'tar' to send
+ *           all the files in one tar stream, or 'stream' to send each
+ *           file through ssh, resolving its macros on the fly.
+ */
+std::string task::get_file_transport() const {
+  std::string const& transport = _obj.macro_content(file_transport_macro);
+  return (transport.empty() ? "scp" : transport);
 }
 
 /**
@@ -174,9 +288,9 @@ bool task::should_be_deleted() const noexcept {
  *  @return  The user, default "centreon".
  */
 std::string task::get_ssh_user() const {
-  std::string user = _obj.macro_content("ssh_user");
+  std::string const& user = _obj.macro_content(ssh_user_macro);
 
-  return (user.empty() ? "centreon" : std::move(user));
+  return (user.empty() ? "centreon" : user);
 }
 
 /**
@@ -185,7 +299,7 @@ std::string task::get_ssh_user() const {
  *  @return  The port, default 22.
  */
 unsigned short task::get_ssh_port() const {
-  std::string port_str = _obj.macro_content("ssh_port");
+  std::string const& port_str = _obj.macro_content(ssh_port_macro);
   unsigned short port = 0;
   try {
     port = std::stoi(port_str);
@@ -193,51 +307,143 @@ unsigned short task::get_ssh_port() const {
   return (port > 0 ? port : 22);
 }
 
+/**
+ *  Get the cipher used by ssh.
+ *
+ *  @return  The cipher, or an empty string for the default of ssh.
+ */
+std::string const& task::get_ssh_cipher() const {
+  return (_obj.macro_content(ssh_cipher_macro));
+}
+
+/**
+ *  Should ssh compress its connection?
+ *
+ *  @return  True or false, default true if files are sent as tar streams.
+ */
+bool task::get_ssh_compression() const {
+  std::string const& compression = _obj.macro_content(ssh_compression_macro);
+  if (compression.empty())
+    return (get_file_transport() == "tar");
+  return (compression == "true");
+}
+
 /**
  *  Get the subnet id.
  *
  *  @return  The subnet id.
  */
-std::string task::get_subnet_id() const {
-  return (_obj.macro_content("subnet_id"));
+std::string const& task::get_subnet_id() const {
+  return (_obj.macro_content(subnet_id_macro));
+}
+
+/**
+ *  Get the launch specification of the instance running this task.
+ *
+ *  @return  The launch specification.
+ */
+aws::ec2::launch_specification task::get_launch_specification() const {
+  aws::ec2::launch_specification spec;
+  spec.set_image_id(get_ami());
+  spec.set_instance_type(get_amazon_instance_type());
+  spec.set_key_name(get_key_name());
+  std::string security_group = get_security_group();
+  if (!security_group.empty()) {
+    aws::ec2::security_group sec;
+    sec.set_group_name(security_group);
+    spec.add_security_groups(sec);
+  }
+  std::string security_group_id = get_security_group_id();
+  if (!security_group_id.empty()) {
+    aws::ec2::security_group sec;
+    sec.set_group_id(security_group_id);
+    spec.add_security_group_ids(sec);
+  }
+  spec.set_subnet_id(get_subnet_id());
+  return (spec);
+}
+
+/**
+ *  Get a key identifying the launch specification of this task.
+ *
+ *  Tasks with the same key can run on the same kind of instance,
+ *  with the same number of slots.
+ *
+ *  @return  The launch specification key.
+ */
+std::string task::get_launch_specification_key() const {
+  std::string key;
+  key.append(get_ami()).append(1, '\0')
+     .append(get_amazon_instance_type()).append(1, '\0')
+     .append(get_key_name()).append(1, '\0')
+     .append(get_security_group()).append(1, '\0')
+     .append(get_security_group_id()).append(1, '\0')
+     .append(get_subnet_id()).append(1, '\0')
+     .append(std::to_string(get_slots()));
+  return (key);
+}
+
+/**
+ *  Get the object of this task.
+ *
+ *  @return  The object of this task.
+ */
+object const& task::get_object() const noexcept {
+  return (_obj);
 }
 
 /**
  *  Validate that the task is well formed.
  */
 void task::_validate() const {
-  if (!_obj.macro_exists("ami"))
+  // Resolve all the macros now: errors are reported here rather than
+  // by the getters, which then find them already resolved.
+  try {
+    _obj.get_macros();
+  } catch (std::exception const& e) {
+    throw (exceptions::basic()
+           << "task: couldn't validate task '"
+           << _obj.get_name() << "': " << e.what());
+  }
+  if (!_obj.macro_exists(ami_macro))
     throw (exceptions::basic()
             << "task: couldn't validate task '"
             << _obj.get_name() << "': macro 'ami'' doesn't exist");
-  if (!_obj.macro_exists("command"))
+  if (!_obj.macro_exists(command_macro))
     throw (exceptions::basic()
            << "task: couldn't validate task '"
            << _obj.get_name() << "': macro 'command' doesn't exist");
-  if (!_obj.macro_exists("type"))
+  if (!_obj.macro_exists(type_macro))
     throw (exceptions::basic()
       << "task: couldn't validate task '"
       << _obj.get_name() << "': macro 'type' doesn't exist");
-  if (!_obj.macro_exists("key"))
+  if (!_obj.macro_exists(key_macro))
     throw (exceptions::basic()
       << "task: couldn't validate task '"
       << _obj.get_name() << "': macro 'key' doesn't exist");
-  if (!_obj.macro_exists("security_group") && !_obj.macro_exists("security_group_id"))
+  if (!_obj.macro_exists(security_group_macro) && !_obj.macro_exists(security_group_id_macro))
     throw (exceptions::basic()
       << "task: couldn't validate task '"
       << _obj.get_name() << "': neither macro 'security_group' "
                             "or 'security_group_id' exist");
+  std::string transport = get_file_transport();
+  if (transport != "scp" && transport != "tar" && transport != "stream")
+    throw (exceptions::basic()
+      << "task: couldn't validate task '"
+      << _obj.get_name() << "': unknown file transport '"
+      << transport << "'");
 }
 
 /**
  *  Resolve the macros of all the files flagged as needed.
+ *
+ *  Streamed files are resolved when they are sent.
  */
 void task::_resolve_file_macros() {
+  if (get_file_transport() == "stream")
+    return ;
   for (auto& file : _obj.get_files_mut()) {
-    if (file.resolve_macro()) {
-      std::string content = file.get_file_content();
-      content = _obj.resolve_macros(content);
-      file.set_resolved_file_content(content);
-    }
+    if (file.resolve_macro())
+      file.resolve_file_content(_obj);
   }
 }
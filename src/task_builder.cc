@@ -0,0 +1,72 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <utility>
+#include "com/centreon/cdash/task_builder.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] obj                  The object of the task.
+ *  @param[in] resolve_file_macros  False if the macros of the files are
+ *                                  already resolved.
+ */
+task_builder::task_builder(object obj, bool resolve_file_macros)
+  : _obj(std::move(obj)),
+    _resolve_file_macros(resolve_file_macros) {
+  set_auto_delete(false);
+}
+
+/**
+ *  Destructor.
+ */
+task_builder::~task_builder() noexcept {}
+
+/**
+ *  Create the task.
+ *
+ *  Errors are stored instead of thrown, they are reported
+ *  by the owner of the builder.
+ */
+void task_builder::run() {
+  try {
+    _task.reset(new task(std::move(_obj), _resolve_file_macros));
+  } catch (std::exception const& e) {
+    _error = e.what();
+  }
+}
+
+/**
+ *  Get the created task.
+ *
+ *  @return  The task, to be moved by the caller. Only valid if there
+ *           was no error.
+ */
+task& task_builder::get_task() noexcept {
+  return (*_task);
+}
+
+/**
+ *  Get the error of the creation.
+ *
+ *  @return  The error, or an empty string if the task was created.
+ */
+std::string const& task_builder::get_error() const noexcept {
+  return (_error);
+}
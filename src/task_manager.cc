@@ -14,9 +14,12 @@
 ** limitations under the License.
 */
 
-#include <unistd.h>
+#include <algorithm>
+#include <set>
 #include <utility>
 #include "com/centreon/cdash/task_manager.hh"
+#include "com/centreon/cdash/spot_request.hh"
+#include "com/centreon/concurrency/thread_pool.hh"
 #include "com/centreon/exceptions/basic.hh"
 #include "com/centreon/aws/ec2/command.hh"
 #include "com/centreon/cdash/log/log.hh"
@@ -26,6 +29,18 @@ using namespace com::centreon;
 using namespace com::centreon::cdash;
 
 volatile bool task_manager::should_exit = false;
+event_loop* volatile task_manager::_running_loop = nullptr;
+
+/**
+ *  Wake up the running task manager, if any.
+ *
+ *  Safe to call from a signal handler.
+ */
+void task_manager::wake_up() noexcept {
+  event_loop* loop = _running_loop;
+  if (loop)
+    loop->notify();
+}
 
 /**
  *  Constructor.
@@ -63,6 +78,18 @@ task_manager& task_manager::operator=(task_manager&& tsk) noexcept {
  *  Destructor.
  */
 task_manager::~task_manager() noexcept {
+  _expire_idle_instances(true);
+  // Only one task process per spot request terminates the instance.
+  for (auto it = _task_processes.begin(), end = _task_processes.end();
+       it != end;
+       ++it) {
+    auto next = it;
+    ++next;
+    if (next != end && next->first == it->first)
+      it->second->release_instance();
+  }
+  if (_running_loop == &_loop)
+    _running_loop = nullptr;
 }
 
 /**
@@ -71,97 +98,372 @@ task_manager::~task_manager() noexcept {
  *  @param[in] sequences  The sequences of tasks.
  */
 void task_manager::run(std::vector<sequence> sequences) {
+  _running_loop = &_loop;
   _create_spot_instances(sequences);
+  _poll_spot_instances();
+  _loop.set_timer(_get_polling_duration());
   while (!should_exit) {
+    size_t idle_count = _idle_instances.size();
+    _reap_finished_tasks();
+    _bind_idle_instances();
+    _expire_idle_instances(false);
+    if (_idle_instances.size() > idle_count)
+      _loop.set_timer(_get_polling_duration());
     if (_task_processes.empty()) {
       LOG()
         << "all task processes terminated";
+      _expire_idle_instances(true);
       return ;
     }
-    _poll_spot_instances();
-    _reap_finished_tasks();
-    ::sleep(_polling_duration);
+    // Wake up on the polling timer, on task process state changes
+    // or on termination signals.
+    if (_loop.wait() & event_loop::timer_expired) {
+      _poll_spot_instances();
+      _loop.set_timer(_get_polling_duration());
+    }
   }
   _poll_spot_instances();
 }
 
 /**
  *  Reap the finished tasks.
+ *
+ *  The instances of the finished tasks are given to waiting tasks
+ *  or kept idle if possible, otherwise they are terminated.
  */
 void task_manager::_reap_finished_tasks() {
+  std::vector<std::unique_ptr<task_process>> finished;
   for (auto it = _task_processes.begin(),
        tmp = it,
        end = _task_processes.end();
        it != end;
        it = tmp) {
     ++tmp;
-    if (it->second->is_finished()
-        || it->second->is_in_fatal_error())
+    bool is_finished = it->second->is_finished();
+    if (is_finished || it->second->is_in_fatal_error()) {
+      std::string id = it->first;
+      std::unique_ptr<task_process> tp(std::move(it->second));
       _task_processes.erase(it);
+      if (is_finished)
+        finished.push_back(std::move(tp));
+      // Other slots still use the instance.
+      else if (_task_processes.count(id))
+        tp->release_instance();
+    }
+  }
+  for (auto& tp : finished)
+    _release_instance(*tp);
+}
+
+/**
+ *  Release the instance of a finished task process.
+ *
+ *  Once all its slots are free, the instance is bound to the task
+ *  processes waiting for an instance with the same launch specification,
+ *  or kept idle during its linger time.
+ *
+ *  @param[in] tp  The finished task process.
+ */
+void task_manager::_release_instance(task_process& tp) {
+  std::string const& id
+    = tp.get_spot_instance().get_spot_instance_request_id();
+  if (_task_processes.count(id)) {
+    tp.release_instance();
+    return ;
+  }
+  for (auto const& idle : _idle_instances)
+    if (idle.second.spot_instance.get_spot_instance_request_id() == id) {
+      tp.release_instance();
+      return ;
+    }
+
+  if (tp.get_instance().get_instance_id().empty())
+    return ;
+
+  if (_bind_waiting_task_processes(
+        tp.get_launch_specification_key(),
+        tp.get_spot_instance(),
+        tp.get_instance(),
+        tp.get_slots(),
+        tp.should_delete_instance()) > 0)
+    tp.release_instance();
+  else if (tp.get_instance_linger_time() > 0) {
+    LOG()
+      << "keeping instance '" << tp.get_instance().get_instance_id()
+      << "' idle for " << tp.get_instance_linger_time() << " seconds";
+    tp.release_instance();
+    idle_instance idle;
+    idle.spot_instance = tp.get_spot_instance();
+    idle.instance = tp.get_instance();
+    idle.idle_until = timestamp::now();
+    idle.idle_until.add_seconds(tp.get_instance_linger_time());
+    idle.should_delete = tp.should_delete_instance();
+    idle.slots = tp.get_slots();
+    // XXX: No emplace because GCC 4.7.
+    _idle_instances.insert(
+      std::make_pair(tp.get_launch_specification_key(), idle));
+  }
+}
+
+/**
+ *  Bind the idle instances to the task processes waiting
+ *  for an instance with the same launch specification.
+ */
+void task_manager::_bind_idle_instances() {
+  for (auto it = _idle_instances.begin(),
+       tmp = it,
+       end = _idle_instances.end();
+       it != end;
+       it = tmp) {
+    ++tmp;
+    if (_bind_waiting_task_processes(
+          it->first,
+          it->second.spot_instance,
+          it->second.instance,
+          it->second.slots,
+          it->second.should_delete) > 0)
+      _idle_instances.erase(it);
+  }
+}
+
+/**
+ *  Bind a running instance to the task processes waiting for an instance
+ *  with the same launch specification.
+ *
+ *  @param[in] key    The launch specification key of the instance.
+ *  @param[in] spi    The spot instance.
+ *  @param[in] ins    The instance.
+ *  @param[in] slots  The number of task processes the instance can run.
+ *  @param[in] should_delete  Should the instance be deleted when it is
+ *                            not used anymore?
+ *
+ *  @return           The number of task processes bound to the instance.
+ */
+unsigned int task_manager::_bind_waiting_task_processes(
+                             std::string const& key,
+                             aws::ec2::spot_instance const& spi,
+                             aws::ec2::instance const& ins,
+                             unsigned int slots,
+                             bool should_delete) {
+  std::vector<task_process_map::iterator> waiting;
+  for (auto it = _task_processes.begin(), end = _task_processes.end();
+       it != end && waiting.size() < slots;
+       ++it)
+    if (it->second->is_waiting_for_instance()
+        && it->second->get_launch_specification_key() == key)
+      waiting.push_back(it);
+
+  for (auto it : waiting) {
+    std::string old_id = it->first;
+    std::unique_ptr<task_process> tp(std::move(it->second));
+    _task_processes.erase(it);
+    // Its own spot request is still used by other slots.
+    if (_task_processes.count(old_id))
+      tp->release_instance();
+    tp->adopt_instance(spi, ins, should_delete);
+    // XXX: No emplace because GCC 4.7.
+    _task_processes.insert(
+      std::make_pair(spi.get_spot_instance_request_id(), std::move(tp)));
+  }
+  return (waiting.size());
+}
+
+/**
+ *  Terminate the idle instances whose linger time is over.
+ *
+ *  @param[in] all  Terminate all the idle instances.
+ */
+void task_manager::_expire_idle_instances(bool all) noexcept {
+  timestamp now = timestamp::now();
+  for (auto it = _idle_instances.begin(),
+       tmp = it,
+       end = _idle_instances.end();
+       it != end;
+       it = tmp) {
+    ++tmp;
+    if (!all && now < it->second.idle_until)
+      continue ;
+    if (it->second.should_delete) {
+      std::string const& id
+        = it->second.spot_instance.get_spot_instance_request_id();
+      try {
+        LOG()
+          << "terminating idle spot instances '" << id
+          << "' from amazon...";
+        aws::ec2::command cmd(_profile);
+        cmd.cancel_spot_instance_request(id);
+        cmd.terminate_instance(it->second.instance.get_instance_id());
+      } catch (std::exception const& e) {
+        ERROR()
+          << "couldn't terminate idle spot instances '" << id
+          << "' from amazon: " << e.what();
+      }
+    }
+    _idle_instances.erase(it);
   }
 }
 
 /**
  *  Create the requested spot instances.
  *
- *  @param[in] tasks  The requested spot instances.
+ *  Sequences are grouped by launch specification and each group is
+ *  requested in one call. Groups are requested concurrently.
+ *
+ *  @param[in] sequences  The sequences of tasks.
  */
 void task_manager::_create_spot_instances(
                      std::vector<sequence>& sequences) {
-  aws::ec2::command cmd(_profile);
   timestamp valid_until = timestamp::now();
   valid_until.add_seconds(_validity_time_duration);
 
-  for (auto& sequence : sequences) {
-    task const& tsk = sequence.get_current_task();
-    aws::ec2::launch_specification spec;
-    spec.set_image_id(tsk.get_ami());
-    spec.set_instance_type(tsk.get_amazon_instance_type());
-    spec.set_key_name(tsk.get_key_name());
-    if (!tsk.get_security_group().empty()) {
-      aws::ec2::security_group sec;
-      sec.set_group_name(tsk.get_security_group());
-      spec.add_security_groups(sec);
-    }
-    if (!tsk.get_security_group_id().empty()) {
-      aws::ec2::security_group sec;
-      sec.set_group_id(tsk.get_security_group_id());
-      spec.add_security_group_ids(sec);
+  // Group the sequences by launch specification.
+  std::map<std::string, std::vector<sequence*>> groups;
+  for (auto& sequence : sequences)
+    groups[sequence.get_current_task().get_launch_specification_key()]
+      .push_back(&sequence);
+
+  // Request each group concurrently.
+  // Each instance runs as many sequences as it has slots.
+  std::vector<std::unique_ptr<spot_request>> requests;
+  {
+    concurrency::thread_pool pool(_max_concurrent_requests);
+    for (auto const& group : groups) {
+      task const& tsk = group.second.front()->get_current_task();
+      unsigned int slots = tsk.get_slots();
+      unsigned int count = (group.second.size() + slots - 1) / slots;
+      LOG()
+        << "requesting " << count
+        << " spot instance(s) of type '" << tsk.get_amazon_instance_type()
+        << "' with " << slots << " slot(s) for task '"
+        << tsk.get_name() << "'";
+      std::unique_ptr<spot_request> request(
+        new spot_request(
+              _profile,
+              tsk.get_launch_specification(),
+              count,
+              _price,
+              valid_until));
+      pool.start(request.get());
+      requests.push_back(std::move(request));
     }
-    spec.set_subnet_id(tsk.get_subnet_id());
-    LOG()
-      << "requesting spot instance for task '"
-      << tsk.get_name() << "'";
-    auto const& instances = cmd.request_spot_instance(
-                                  _price,
-                                  1,
-                                  "persistent",
-                                  timestamp(),
-                                  valid_until,
-                                  spec);
-    LOG()
-      << "got spot instance '"
-      << instances.back().get_spot_instance_request_id()
-      << "' for task '" << tsk.get_name() << "'";
+    pool.wait_for_done();
+  }
+
+  for (auto const& request : requests)
     _spot_instances.insert(
       _spot_instances.end(),
-      instances.begin(),
-      instances.end());
-    std::unique_ptr<task_process> process(
-      new task_process(
-            _profile,
-            std::move(sequence),
-            _spot_instances.back()));
-    // XXX: No emplace because GCC 4.7.
-    _task_processes.insert(
-      std::make_pair(
-        _spot_instances.back().get_spot_instance_request_id(),
-        std::move(process)));
+      request->get_spot_instances().begin(),
+      request->get_spot_instances().end());
+
+  // Map the spot instances back to the sequences.
+  std::string error;
+  std::vector<aws::ec2::spot_instance> unbound;
+  std::vector<aws::ec2::spot_instance>::const_iterator
+    spi = _spot_instances.begin();
+  auto request = requests.begin();
+  for (auto& group : groups) {
+    if (!(*request)->get_error().empty()) {
+      ERROR()
+        << "couldn't request spot instances for task '"
+        << group.second.front()->get_current_task().get_name()
+        << "': " << (*request)->get_error();
+      if (error.empty())
+        error = (*request)->get_error();
+    }
+    unsigned int slots
+      = group.second.front()->get_current_task().get_slots();
+    size_t bound = std::min(
+                     group.second.size(),
+                     (*request)->get_spot_instances().size() * slots);
+    for (size_t i = 0; i < bound; ++i) {
+      sequence& seq = *group.second[i];
+      aws::ec2::spot_instance const& ins = *(spi + i / slots);
+      LOG()
+        << "got spot instance '" << ins.get_spot_instance_request_id()
+        << "' for task '" << seq.get_current_task().get_name() << "'";
+      std::unique_ptr<task_process> process(
+        new task_process(
+              _profile,
+              std::move(seq),
+              ins,
+              _loop));
+      // XXX: No emplace because GCC 4.7.
+      _task_processes.insert(
+        std::make_pair(
+          ins.get_spot_instance_request_id(),
+          std::move(process)));
+    }
+    // The spot instances left without a sequence aren't needed.
+    for (size_t i = (bound + slots - 1) / slots;
+         i < (*request)->get_spot_instances().size();
+         ++i)
+      unbound.push_back(*(spi + i));
+    spi += (*request)->get_spot_instances().size();
+    ++request;
+  }
+
+  // Persistent requests would keep launching instances.
+  _cancel_spot_instances(unbound);
+  if (!error.empty())
+    throw (exceptions::basic()
+           << "task_manager: couldn't request spot instances: " << error);
+}
+
+/**
+ *  Cancel spot instances that aren't bound to any task process, and
+ *  terminate their instance if they have one.
+ *
+ *  @param[in] spis  The spot instances.
+ */
+void task_manager::_cancel_spot_instances(
+                     std::vector<aws::ec2::spot_instance> const& spis)
+                     noexcept {
+  for (auto const& spi : spis) {
+    std::string const& id = spi.get_spot_instance_request_id();
+    try {
+      LOG()
+        << "cancelling unused spot instances '" << id
+        << "' from amazon...";
+      aws::ec2::command cmd(_profile);
+      cmd.cancel_spot_instance_request(id);
+      if (!spi.get_instance_id().empty())
+        cmd.terminate_instance(spi.get_instance_id());
+    } catch (std::exception const& e) {
+      ERROR()
+        << "couldn't cancel unused spot instances '" << id
+        << "' from amazon: " << e.what();
+    }
   }
 }
 
+/**
+ *  Describe several instances.
+ *
+ *  @param[in] cmd  The aws command.
+ *  @param[in] ids  The ids of the instances.
+ *
+ *  @return  The instances.
+ */
+static std::vector<aws::ec2::instance> describe_instances(
+                                         aws::ec2::command& cmd,
+                                         std::vector<std::string> const& ids) {
+#ifdef CDASH_CLIB_HAS_INSTANCES_FROM_IDS
+  return (cmd.get_instances_from_ids(ids));
+#else
+  // This Centreon Clib describes one instance per call.
+  std::vector<aws::ec2::instance> instances;
+  for (auto const& id : ids)
+    instances.push_back(cmd.get_instance_from_id(id));
+  return (instances);
+#endif // CDASH_CLIB_HAS_INSTANCES_FROM_IDS
+}
+
 /**
  *  Poll the spot instances from aws.
+ *
+ *  The instances of all the active spot instances are described in
+ *  batches, instead of one aws call per instance, when Centreon Clib
+ *  supports it.
  */
 void task_manager::_poll_spot_instances() {
   aws::ec2::command cmd(_profile);
@@ -170,15 +472,82 @@ void task_manager::_poll_spot_instances() {
   LOG()
     << "got " << _spot_instances.size() << " spot instances from amazon";
 
+  std::multimap<std::string, task_process*> active;
+  std::set<std::string> active_requests;
   for (auto const& spot_instance : _spot_instances) {
-    auto found = _task_processes.find(
+    if (spot_instance.get_state() == aws::ec2::spot_instance::active)
+      active_requests.insert(spot_instance.get_spot_instance_request_id());
+    auto range = _task_processes.equal_range(
                    spot_instance.get_spot_instance_request_id());
-    if (found != _task_processes.end()) {
-      found->second->visit(spot_instance);
+    for (auto it = range.first; it != range.second; ++it) {
+      it->second->visit(spot_instance);
       if (spot_instance.get_state() == aws::ec2::spot_instance::active)
-        found->second->visit(
-          cmd.get_instance_from_id(spot_instance.get_instance_id()));
+        // XXX: No emplace because GCC 4.7.
+        active.insert(
+          std::make_pair(
+            spot_instance.get_instance_id(),
+            it->second.get()));
+    }
+  }
+
+  // Forget the idle instances that were lost.
+  for (auto it = _idle_instances.begin(),
+       tmp = it,
+       end = _idle_instances.end();
+       it != end;
+       it = tmp) {
+    ++tmp;
+    if (active_requests.find(
+          it->second.spot_instance.get_spot_instance_request_id())
+        == active_requests.end()) {
+      LOG()
+        << "idle instance '" << it->second.instance.get_instance_id()
+        << "' is not active anymore";
+      _idle_instances.erase(it);
+    }
+  }
+
+  // Describe the active instances, chunked to the api limits.
+  std::vector<std::string> ids;
+  for (auto it = active.begin(), end = active.end(); it != end;) {
+    ids.push_back(it->first);
+    it = active.upper_bound(it->first);
+    if (ids.size() == _describe_chunk_size || it == end) {
+      for (auto const& ins : describe_instances(cmd, ids)) {
+        auto range = active.equal_range(ins.get_instance_id());
+        for (auto found = range.first; found != range.second; ++found)
+          found->second->visit(ins);
+      }
+      ids.clear();
     }
   }
 }
 
+/**
+ *  Get the duration until the next poll of the spot instances.
+ *
+ *  Poll quickly while task processes wait for amazon, slowly once
+ *  everything is running, and not after the end of the linger time
+ *  of an idle instance.
+ *
+ *  @return  The polling duration, in seconds.
+ */
+unsigned int task_manager::_get_polling_duration() {
+  unsigned int duration = _slow_polling_duration;
+  for (auto const& tp : _task_processes)
+    if (tp.second->is_waiting_for_instance()) {
+      duration = _fast_polling_duration;
+      break ;
+    }
+
+  // Wake up in time to terminate the idle instances.
+  long now = timestamp::now().to_seconds();
+  for (auto const& idle : _idle_instances) {
+    long left = idle.second.idle_until.to_seconds() - now;
+    if (left < 1)
+      left = 1;
+    if (static_cast<unsigned long>(left) < duration)
+      duration = left;
+  }
+  return (duration);
+}
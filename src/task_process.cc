@@ -14,6 +14,8 @@
 ** limitations under the License.
 */
 
+#include <cctype>
+#include <sys/stat.h>
 #include "com/centreon/concurrency/locker.hh"
 #include "com/centreon/cdash/ssh_wrapper.hh"
 #include "com/centreon/cdash/task_process.hh"
@@ -26,25 +28,53 @@ using namespace com::centreon;
 using namespace com::centreon::cdash;
 using namespace com::centreon::aws::ec2;
 
+// Index of the next task process, making its working directory unique.
+// Task processes are only created by the thread of the task manager.
+static unsigned int next_task_process_index = 0;
+
 /**
  *  Default constructor.
  *
  *  @param[in] profile        The profile associated with this task process.
  *  @param[in] seq            The sequence of tasks associated with this task process.
  *  @param[in] spi            The spot instance associated with this task process.
+ *  @param[in] loop           The event loop notified of state changes.
  */
 task_process::task_process(
                 std::string profile,
                 sequence seq,
-                aws::ec2::spot_instance const& spi)
+                aws::ec2::spot_instance const& spi,
+                event_loop& loop)
   : _profile(std::move(profile)),
+    _loop(loop),
     _sequence(std::move(seq)),
-    _spot_instance(&spi),
+    _spot_instance(spi),
+    _owns_instance(true),
+    _should_delete(_sequence.get_current_task().should_be_deleted()),
+    _launch_specification_key(
+      _sequence.get_current_task().get_launch_specification_key()),
+    _linger_time(_sequence.get_current_task().get_instance_linger_time()),
+    _slots(_sequence.get_current_task().get_slots()),
     _state(waiting_for_spot_instance),
     _process(this) {
+  for (unsigned int i = 0; i < _max_concurrent_transfers; ++i)
+    _transfers.push_back(std::unique_ptr<process>(new process(this)));
+  // Sequences sharing an instance each work in their own directory.
+  // Different names may give the same directory once sanitized: the
+  // index of the task process makes it unique.
+  if (_slots > 1) {
+    _working_directory = "cdash-" + _sequence.get_current_task().get_name();
+    for (auto& c : _working_directory)
+      if (!::isalnum(static_cast<unsigned char>(c))
+          && c != '-' && c != '_' && c != '.')
+        c = '_';
+    _working_directory.append("-")
+                      .append(std::to_string(next_task_process_index));
+  }
+  ++next_task_process_index;
   LOG(_sequence.get_current_task().get_name())
     << "creating task process bound to the spot instance '"
-    << _spot_instance->get_spot_instance_request_id() << "'"
+    << _spot_instance.get_spot_instance_request_id() << "'"
        ": waiting for spot instance activation...";
   _clear();
   visit(spi);
@@ -55,12 +85,13 @@ task_process::task_process(
  */
 task_process::~task_process() noexcept {
   concurrency::locker lock(&_mut);
-  if (_state == running || _state == copying_files) {
+  if (_state == running
+      || _state == copying_files
+      || _state == creating_working_directory) {
     _state = ended;
     try {
       lock.unlock();
-      _process.terminate();
-      _process.wait();
+      _terminate_processes();
     } catch (std::exception const& e) {
       ERROR(_sequence.ended() ?
               "" :
@@ -78,7 +109,7 @@ task_process::~task_process() noexcept {
  *  @return  The spot instance associated with this task process.
  */
 aws::ec2::spot_instance const& task_process::get_spot_instance() const noexcept {
-  return (*_spot_instance);
+  return (_spot_instance);
 }
 
 /**
@@ -90,6 +121,43 @@ aws::ec2::instance const& task_process::get_instance() const noexcept {
   return (_instance);
 }
 
+/**
+ *  Get the launch specification key of the instance of this task process.
+ *
+ *  @return  The launch specification key.
+ */
+std::string const& task_process::get_launch_specification_key() const noexcept {
+  return (_launch_specification_key);
+}
+
+/**
+ *  Get how long the instance should stay idle, waiting for another
+ *  sequence, once this task process is finished.
+ *
+ *  @return  The linger time, in seconds.
+ */
+unsigned int task_process::get_instance_linger_time() const noexcept {
+  return (_linger_time);
+}
+
+/**
+ *  Get the number of task processes the instance can run.
+ *
+ *  @return  The number of slots of the instance.
+ */
+unsigned int task_process::get_slots() const noexcept {
+  return (_slots);
+}
+
+/**
+ *  Should the instance be deleted when it is not used anymore?
+ *
+ *  @return  True or false.
+ */
+bool task_process::should_delete_instance() const noexcept {
+  return (_should_delete);
+}
+
 /**
  *  Update the process with spot instance data.
  *
@@ -100,19 +168,43 @@ aws::ec2::instance const& task_process::get_instance() const noexcept {
  */
 void task_process::visit(aws::ec2::spot_instance const& spi) {
   concurrency::locker lock(&_mut);
-  _spot_instance = &spi;
+  _spot_instance = spi;
   spot_instance::spot_instance_state spot_state = spi.get_state();
 
-  if (spot_state == spot_instance::failed
-      || spot_state == spot_instance::canceled
-      || spot_state == spot_instance::closed) {
+  if ((_state == creating_working_directory
+       || _state == copying_files
+       || _state == running
+       || _state == copying_files_back)
+      && (spot_state == spot_instance::open
+          || (spot_state == spot_instance::active
+              && spi.get_instance_id() != _instance.get_instance_id()))) {
+    // A persistent spot request reopens when its instance is interrupted,
+    // and may already be fulfilled again by another instance when it is
+    // polled. Change state first so that the finished() callback of the
+    // terminated process doesn't start anything.
+    _state = waiting_for_spot_instance;
+    lock.unlock();
+    _terminate_processes();
+    lock.relock();
+    unsigned int resumed = _sequence.resume();
+    ERROR(_sequence.get_current_task().get_name())
+      << "spot instance was interrupted while the task is running,"
+         " resuming the sequence at task " << resumed + 1
+      << " (" << _sequence.get_completed_tasks().size()
+      << " completed task(s) kept) and waiting for a retry...";
+    _clear();
+    if (spot_state == spot_instance::active)
+      _state = waiting_for_instance;
+  }
+  else if (spot_state == spot_instance::failed
+           || spot_state == spot_instance::canceled
+           || spot_state == spot_instance::closed) {
     ERROR(_sequence.get_current_task().get_name())
       << "spot instance failed";
+    _state = error;
     lock.unlock();
-    _process.terminate();
-    _process.wait();
+    _terminate_processes();
     lock.relock();
-    _state = error;
   }
   else if (_state == waiting_for_spot_instance
            && spot_state == spot_instance::active) {
@@ -120,19 +212,6 @@ void task_process::visit(aws::ec2::spot_instance const& spi) {
       << "spot instance active, waiting for instance...";
     _state = waiting_for_instance;
   }
-  else if ((_state == running || _state == copying_files)
-           && spot_state == spot_instance::closed) {
-    ERROR(_sequence.get_current_task().get_name())
-      << "spot instance was closed while the task is running,"
-         " resetting sequence of tasks and waiting for a retry...";
-    _state = waiting_for_spot_instance;
-    lock.unlock();
-    _process.terminate();
-    _process.wait();
-    lock.relock();
-    _sequence.reset();
-    _clear();
-  }
 }
 
 /**
@@ -167,6 +246,17 @@ bool task_process::is_finished() {
   return (_state == ended);
 }
 
+/**
+ *  Is this task waiting for its spot instance or its instance?
+ *
+ *  @return  True or false.
+ */
+bool task_process::is_waiting_for_instance() {
+  concurrency::locker _(&_mut);
+  return (_state == waiting_for_spot_instance
+          || _state == waiting_for_instance);
+}
+
 /**
  *  Is this task in a fatal error ?
  *
@@ -177,6 +267,42 @@ bool task_process::is_in_fatal_error() {
   return (_state == error);
 }
 
+/**
+ *  Stop owning the instance: it won't be terminated with this task process.
+ */
+void task_process::release_instance() {
+  concurrency::locker _(&_mut);
+  _owns_instance = false;
+}
+
+/**
+ *  Run the sequence on an already running instance, released by another
+ *  task process. The spot instance requested for this task process is
+ *  not needed anymore and is cancelled.
+ *
+ *  @param[in] spi            The spot instance to adopt.
+ *  @param[in] ins            The instance to adopt.
+ *  @param[in] should_delete  Should the adopted instance be deleted
+ *                            when it is not used anymore?
+ */
+void task_process::adopt_instance(
+                     aws::ec2::spot_instance const& spi,
+                     aws::ec2::instance const& ins,
+                     bool should_delete) {
+  concurrency::locker _(&_mut);
+  LOG(_sequence.get_current_task().get_name())
+    << "reusing idle instance '" << ins.get_instance_id()
+    << "' of spot instance '" << spi.get_spot_instance_request_id()
+    << "', starting task...";
+  _cancel_spot_request();
+  _spot_instance = spi;
+  _instance = ins;
+  _owns_instance = true;
+  _should_delete = should_delete;
+  _state = waiting_for_instance;
+  _run();
+}
+
 /**
  *  Data is available callback.
  *
@@ -186,7 +312,17 @@ void task_process::data_is_available(process& p) noexcept {
   concurrency::locker _(&_mut);
   std::string data;
   p.read(data);
-  _out.append(data);
+  if (&p == &_process && _archive.get()) {
+    if (_archive_error.empty()) {
+      try {
+        _archive->feed(data.data(), data.size());
+      } catch (std::exception const& e) {
+        _archive_error = e.what();
+      }
+    }
+  }
+  else
+    _out.append(data);
 }
 
 /**
@@ -198,7 +334,7 @@ void task_process::data_is_available_err(process& p) noexcept {
   concurrency::locker _(&_mut);
   std::string data;
   p.read_err(data);
-  _err_out.append(data);
+  _err_out[&p].append(data);
 }
 
 /**
@@ -208,12 +344,26 @@ void task_process::data_is_available_err(process& p) noexcept {
  */
 void task_process::finished(process& p) noexcept {
   concurrency::locker _(&_mut);
-  if (p.exit_code() != 0 || p.exit_status() != process::normal) {
+  if (&p == &_process) {
+    _wait_for_bundle();
+    _finish_archive();
+  }
+  if (&p != &_process)
+    _transfer_finished(p);
+  else if (p.exit_code() != 0 || p.exit_status() != process::normal) {
     ERROR(_sequence.get_current_task().get_name())
-      << "error in process execution: '" << _err_out << "'";
-    if (_state != ended)
+      << "error in process execution: '" << _err_out[&p] << "'";
+    if (_state == creating_working_directory
+        || _state == copying_files
+        || _state == running
+        || _state == copying_files_back)
       _run();
   }
+  else if (_state == creating_working_directory) {
+    LOG(_sequence.get_current_task().get_name())
+      << "working directory '" << _working_directory << "' created";
+    _run();
+  }
   else if (_state == copying_files) {
     LOG(_sequence.get_current_task().get_name())
       << "copy finished";
@@ -230,6 +380,8 @@ void task_process::finished(process& p) noexcept {
       << "copy finished";
     _run();
   }
+  // Let the task manager reap us without waiting for its next poll.
+  _loop.notify();
 }
 
 /**
@@ -238,6 +390,8 @@ void task_process::finished(process& p) noexcept {
 void task_process::_clear() {
   _files_to_copy = _sequence.get_current_task().get_files();
   _files_to_copy_back = _sequence.get_current_task().get_returned_files();
+  _transfers_in_flight.clear();
+  _archive.reset();
   _out.clear();
   _err_out.clear();
 }
@@ -247,51 +401,64 @@ void task_process::_clear() {
  */
 void task_process::_run() {
   task const& current_task = _sequence.get_current_task();
-  ssh_wrapper wrapper(
-                _get_ip(),
-                current_task.get_ssh_port(),
-                current_task.get_ssh_user());
+  ssh_wrapper wrapper(_get_ssh_wrapper());
 
   _out.clear();
-  _err_out.clear();
+  _err_out.erase(&_process);
 
-  if (_files_to_copy.size() != 0) {
-    _state = copying_files;
-    file fl = _files_to_copy.back();
-    _files_to_copy.pop_back();
+  if (_state == waiting_for_instance && !_working_directory.empty()) {
+    _state = creating_working_directory;
     LOG(current_task.get_name())
-      << "copying local file '" << fl.get_local_filename()
-      << "' to remote file '" << fl.get_remote_filename() << "'";
-    wrapper.copy_file(
+      << "creating working directory '" << _working_directory << "'";
+    // Start from an empty directory, whatever the instance holds.
+    wrapper.execute(
               _process,
-              fl.resolve_macro() ? fl.get_temporary_file() :
-                                   fl.get_local_filename(),
-              fl.get_remote_filename(),
+              "rm -rf " + _working_directory
+              + " && mkdir " + _working_directory,
               current_task.get_key_file(),
               current_task.get_ssh_timeout());
   }
-  else if (_state == copying_files || _state == waiting_for_instance) {
+  else if (_files_to_copy.size() != 0) {
+    _state = copying_files;
+    LOG(current_task.get_name())
+      << "copying " << _files_to_copy.size() << " local file(s)";
+    if (current_task.get_file_transport() == "tar")
+      _start_bundle();
+    else
+      _start_transfers();
+  }
+  else if (_state == copying_files
+           || _state == waiting_for_instance
+           || _state == creating_working_directory) {
     _state = running;
+    std::string command = current_task.get_command();
+    if (!_working_directory.empty())
+      command = "cd " + _working_directory + " && " + command;
     LOG(current_task.get_name())
-      << "executing command '"
-      << current_task.get_command() << "'";
+      << "executing command '" << command << "'";
     wrapper.execute(
               _process,
-              current_task.get_command(),
+              command,
               current_task.get_key_file(),
               current_task.get_ssh_timeout());
   }
+  else if (_files_to_copy_back.size() != 0
+           && current_task.get_file_transport() == "tar") {
+    _state = copying_files_back;
+    _start_archive();
+  }
   else if (_files_to_copy_back.size() != 0) {
     _state = copying_files_back;
     file fl = _files_to_copy_back.back();
     _files_to_copy_back.pop_back();
+    std::string remote_filename = _get_remote_filename(fl);
     LOG(current_task.get_name())
-      << "copying back remote file '" << fl.get_remote_filename()
+      << "copying back remote file '" << remote_filename
       << "' to local file '" << fl.get_local_filename() << "'";
     wrapper.copy_file_back(
               _process,
               fl.get_local_filename(),
-              fl.get_remote_filename(),
+              remote_filename,
               current_task.get_key_file(),
               current_task.get_ssh_timeout());
   }
@@ -304,6 +471,7 @@ void task_process::_run() {
  */
 void task_process::_start_next_task() {
   // Go to next task or end.
+  _sequence.checkpoint();
   if (!_sequence.next_task())
     _state = ended;
   else {
@@ -315,29 +483,301 @@ void task_process::_start_next_task() {
   }
 }
 
+/**
+ *  Upload the remaining files, on all the free transfer processes.
+ */
+void task_process::_start_transfers() {
+  for (auto& p : _transfers) {
+    if (_files_to_copy.empty())
+      break ;
+    if (_transfers_in_flight.find(p.get()) == _transfers_in_flight.end())
+      _start_transfer(*p);
+  }
+}
+
+/**
+ *  Upload the next remaining file.
+ *
+ *  @param[in] p  The free transfer process to use.
+ */
+void task_process::_start_transfer(process& p) {
+  task const& current_task = _sequence.get_current_task();
+  ssh_wrapper wrapper(_get_ssh_wrapper());
+
+  file fl = _files_to_copy.back();
+  _files_to_copy.pop_back();
+  std::string remote_filename = _get_remote_filename(fl);
+  LOG(current_task.get_name())
+    << "copying local file '" << fl.get_local_filename()
+    << "' to remote file '" << remote_filename << "'";
+  _transfers_in_flight[&p] = fl;
+  _err_out.erase(&p);
+  if (current_task.get_file_transport() == "stream") {
+    struct stat st;
+    unsigned int mode = 0644;
+    if (::stat(fl.get_local_filename().c_str(), &st) == 0)
+      mode = st.st_mode;
+    wrapper.write_file(
+              p,
+              remote_filename,
+              mode,
+              current_task.get_key_file(),
+              current_task.get_ssh_timeout());
+    std::unique_ptr<file_stream> stream(
+      new file_stream(p, fl, current_task.get_object()));
+    stream->exec();
+    _streams[&p] = std::move(stream);
+  }
+  else
+    wrapper.copy_file(
+              p,
+              fl.resolve_macro() ? fl.get_temporary_file() :
+                                   fl.get_local_filename(),
+              remote_filename,
+              current_task.get_key_file(),
+              current_task.get_ssh_timeout());
+}
+
+/**
+ *  Send all the remaining files in one tar stream, extracted remotely.
+ */
+void task_process::_start_bundle() {
+  task const& current_task = _sequence.get_current_task();
+  ssh_wrapper wrapper(_get_ssh_wrapper());
+
+  std::unique_ptr<file_bundle> bundle(new file_bundle(_process));
+  for (auto const& fl : _files_to_copy)
+    bundle->add_file(
+              fl.get_local_filename(),
+              fl.resolve_macro() ? fl.get_temporary_file() :
+                                   fl.get_local_filename(),
+              _get_remote_filename(fl));
+  _files_to_copy.clear();
+  wrapper.extract_archive(
+            _process,
+            current_task.get_key_file(),
+            current_task.get_ssh_timeout());
+  bundle->exec();
+  _bundle = std::move(bundle);
+}
+
+/**
+ *  Wait for the end of the tar stream, if one is being sent.
+ */
+void task_process::_wait_for_bundle() {
+  if (!_bundle.get())
+    return ;
+  _bundle->wait();
+  if (!_bundle->get_error().empty())
+    ERROR(_sequence.get_current_task().get_name())
+      << "error while sending files: " << _bundle->get_error();
+  else
+    LOG(_sequence.get_current_task().get_name())
+      << "sent " << _bundle->get_size() << " bytes of files";
+  _bundle.reset();
+}
+
+/**
+ *  Receive all the returned files in one tar stream, created remotely.
+ */
+void task_process::_start_archive() {
+  task const& current_task = _sequence.get_current_task();
+  ssh_wrapper wrapper(_get_ssh_wrapper());
+
+  std::unique_ptr<tar_reader> archive(new tar_reader);
+  std::vector<std::string> remote_filenames;
+  for (auto const& fl : _files_to_copy_back) {
+    std::string remote_filename = _get_remote_filename(fl);
+    // The remote shell starts in the home directory, and tar names
+    // the files of the archive exactly as they are given.
+    if (remote_filename.compare(0, 2, "~/") == 0)
+      remote_filename.erase(0, 2);
+    LOG(current_task.get_name())
+      << "copying back remote file '" << remote_filename
+      << "' to local file '" << fl.get_local_filename() << "'";
+    archive->add_file(remote_filename, fl.get_local_filename());
+    remote_filenames.push_back(remote_filename);
+  }
+  _files_to_copy_back.clear();
+  _archive = std::move(archive);
+  _archive_error.clear();
+  _archive_start = timestamp::now();
+  wrapper.create_archive(
+            _process,
+            remote_filenames,
+            current_task.get_key_file(),
+            current_task.get_ssh_timeout());
+}
+
+/**
+ *  Check the received tar stream, if one is being received, and
+ *  report what was retrieved.
+ */
+void task_process::_finish_archive() {
+  if (!_archive.get())
+    return ;
+  std::string const& name = _sequence.get_current_task().get_name();
+  if (_archive_error.empty()) {
+    try {
+      _archive->finish();
+    } catch (std::exception const& e) {
+      _archive_error = e.what();
+    }
+  }
+
+  long elapsed = timestamp::now().to_mseconds()
+                 - _archive_start.to_mseconds();
+  if (elapsed <= 0)
+    elapsed = 1;
+  unsigned long long total = 0;
+  for (auto const& extracted : _archive->get_extracted_files()) {
+    LOG(name)
+      << "retrieved remote file '" << extracted.first << "': "
+      << extracted.second << " bytes";
+    total += extracted.second;
+  }
+  LOG(name)
+    << "retrieved " << total << " bytes of files in " << elapsed
+    << " ms (" << total * 1000 / elapsed / 1024 << " KiB/s)";
+  if (!_archive_error.empty())
+    ERROR(name)
+      << "error while retrieving files: " << _archive_error;
+  _archive.reset();
+}
+
+/**
+ *  A transfer process finished: start the next upload, or run the
+ *  command once all the files are uploaded.
+ *
+ *  @param[in] p  The transfer process.
+ */
+void task_process::_transfer_finished(process& p) {
+  bool sent = _wait_for_stream(p);
+  auto found = _transfers_in_flight.find(&p);
+  if (found == _transfers_in_flight.end())
+    return ;
+  if (!sent
+      || p.exit_code() != 0
+      || p.exit_status() != process::normal)
+    ERROR(_sequence.get_current_task().get_name())
+      << "error while copying local file '"
+      << found->second.get_local_filename() << "': '" << _err_out[&p]
+      << "'";
+  _transfers_in_flight.erase(found);
+  _err_out.erase(&p);
+
+  if (_state != copying_files)
+    return ;
+  if (!_files_to_copy.empty())
+    _start_transfer(p);
+  else if (_transfers_in_flight.empty()) {
+    LOG(_sequence.get_current_task().get_name())
+      << "copy finished";
+    _run();
+  }
+}
+
+/**
+ *  Wait for the end of the content streamed on a transfer process,
+ *  if one is being sent.
+ *
+ *  @param[in] p  The transfer process.
+ *
+ *  @return  False if the content couldn't be sent.
+ */
+bool task_process::_wait_for_stream(process& p) {
+  auto found = _streams.find(&p);
+  if (found == _streams.end())
+    return (true);
+  file_stream& stream = *found->second;
+  stream.wait();
+  bool sent = stream.get_error().empty();
+  if (!sent)
+    ERROR(_sequence.get_current_task().get_name())
+      << "error while sending local file '"
+      << stream.get_file().get_local_filename() << "': "
+      << stream.get_error();
+  else
+    LOG(_sequence.get_current_task().get_name())
+      << "sent " << stream.get_size() << " bytes of local file '"
+      << stream.get_file().get_local_filename() << "'";
+  _streams.erase(found);
+  return (sent);
+}
+
+/**
+ *  Terminate the running processes and wait for them.
+ *
+ *  Must be called without holding the task process lock.
+ */
+void task_process::_terminate_processes() {
+  _process.terminate();
+  _process.wait();
+  {
+    concurrency::locker lock(&_mut);
+    _wait_for_bundle();
+    _archive.reset();
+  }
+  for (auto& p : _transfers) {
+    p->terminate();
+    p->wait();
+  }
+  concurrency::locker lock(&_mut);
+  for (auto& p : _transfers)
+    _wait_for_stream(*p);
+}
+
 /**
  *  Terminate the associated instances of a task.
  */
 void task_process::_terminate_associated_instance() {
-  _sequence.reset();
-  if (_sequence.get_current_task().should_be_deleted()) {
+  if (_owns_instance && _should_delete) {
     try {
       LOG()
         << "terminating spot instances '"
-        << _spot_instance->get_spot_instance_request_id()
+        << _spot_instance.get_spot_instance_request_id()
         << "' from amazon...";
+      if (_ssh.get())
+        _ssh->close_master();
       aws::ec2::command cmd(_profile);
       cmd.cancel_spot_instance_request(
-            _spot_instance->get_spot_instance_request_id());
+            _spot_instance.get_spot_instance_request_id());
       if (!_instance.get_instance_id().empty())
         cmd.terminate_instance(_instance.get_instance_id());
     } catch (std::exception const& e) {
       ERROR()
          << "couldn't terminate spot instances '"
-         << _spot_instance->get_spot_instance_request_id()
+         << _spot_instance.get_spot_instance_request_id()
          << "'' from amazon: " << e.what();
     }
   }
+  _owns_instance = false;
+  _ssh.reset();
+}
+
+/**
+ *  Cancel the spot request of this task process, which was never used,
+ *  whether its instance should be deleted or not.
+ */
+void task_process::_cancel_spot_request() {
+  if (_owns_instance) {
+    std::string const& id = _spot_instance.get_spot_instance_request_id();
+    try {
+      LOG()
+        << "cancelling unused spot instances '" << id
+        << "' from amazon...";
+      aws::ec2::command cmd(_profile);
+      cmd.cancel_spot_instance_request(id);
+      if (!_spot_instance.get_instance_id().empty())
+        cmd.terminate_instance(_spot_instance.get_instance_id());
+    } catch (std::exception const& e) {
+      ERROR()
+         << "couldn't cancel unused spot instances '" << id
+         << "' from amazon: " << e.what();
+    }
+  }
+  _owns_instance = false;
+  _ssh.reset();
 }
 
 /**
@@ -351,3 +791,38 @@ std::string const& task_process::_get_ip() const noexcept {
   else
     return (_instance.get_private_ip_address());
 }
+
+/**
+ *  Get an ssh wrapper to the actual instance, configured for the
+ *  current task.
+ *
+ *  @return  The ssh wrapper.
+ */
+ssh_wrapper task_process::_get_ssh_wrapper() {
+  task const& current_task = _sequence.get_current_task();
+  ssh_wrapper wrapper(
+                _get_ip(),
+                current_task.get_ssh_port(),
+                current_task.get_ssh_user());
+  wrapper.set_cipher(current_task.get_ssh_cipher());
+  wrapper.set_compression(current_task.get_ssh_compression());
+  _ssh.reset(new ssh_wrapper(wrapper));
+  return (wrapper);
+}
+
+/**
+ *  Get the remote filename of a file, relative to the working directory.
+ *
+ *  @param[in] fl  The file.
+ *
+ *  @return  The remote filename to use.
+ */
+std::string task_process::_get_remote_filename(file const& fl) const {
+  std::string const& remote = fl.get_remote_filename();
+  if (_working_directory.empty()
+      || remote.empty()
+      || remote[0] == '/'
+      || remote[0] == '~')
+    return (remote);
+  return (_working_directory + "/" + remote);
+}
@@ -21,9 +21,12 @@ using namespace com::centreon::cdash::xml;
 
 /**
  *  Initialize libxml2.
+ *
+ *  Must be done before parsing documents in several threads.
  */
 library::library() {
   LIBXML_TEST_VERSION;
+  xmlInitParser();
 }
 
 /**
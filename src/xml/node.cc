@@ -153,6 +153,28 @@ std::string node::get_name() const {
             std::string((const char*)(_node->name)) : std::string());
 }
 
+/**
+ *  Get the name of this node, without copying it.
+ *
+ *  @return  The name of this node, owned by the document, or nullptr.
+ */
+char const* node::get_name_data() const noexcept {
+  return (_node ? (char const*)(_node->name) : nullptr);
+}
+
+/**
+ *  Check the name of this node, without copying it.
+ *
+ *  @param[in] name  The name.
+ *
+ *  @return  True if this node has this name.
+ */
+bool node::has_name(char const* name) const noexcept {
+  return (_node
+          && _node->name
+          && xmlStrEqual(_node->name, (xmlChar const*)name));
+}
+
 /**
  *  Get the content of this node.
  *
@@ -168,6 +190,33 @@ std::string node::get_content() const {
   return (std::move(ret));
 }
 
+/**
+ *  Get the content of this node, without copying it when possible.
+ *
+ *  The content of a node with a single text child is the content of
+ *  this child, in the document. Otherwise, the content is built in a
+ *  buffer.
+ *
+ *  @param[out] buffer  Holds the content, if built.
+ *
+ *  @return  The content of this node. It lives as long as the document
+ *           and the buffer.
+ */
+char const* node::get_content_data(std::string& buffer) const {
+  if (!_node)
+    return ("");
+  xmlNodePtr child = _node->children;
+  if (!child)
+    return ("");
+  if (!child->next
+      && (child->type == XML_TEXT_NODE
+          || child->type == XML_CDATA_SECTION_NODE)
+      && child->content)
+    return ((char const*)(child->content));
+  buffer = get_content();
+  return (buffer.c_str());
+}
+
 /**
  *  Find a subnode.
  *
@@ -177,7 +226,7 @@ std::string node::get_content() const {
  */
 node node::get_child(std::string const& name) const noexcept {
   for (auto const& node : *this) {
-    if (node.get_name() == name)
+    if (node.has_name(name.c_str()))
       return (node);
   }
   return (node());
@@ -193,7 +242,7 @@ node node::get_child(std::string const& name) const noexcept {
 std::vector<node> node::get_children(std::string const& name) const noexcept {
   std::vector<node> ret;
   for (auto const& node : *this) {
-    if (node.get_name() == name)
+    if (node.has_name(name.c_str()))
       ret.push_back(node);
   }
   return (std::move(ret));
@@ -0,0 +1,87 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <cstring>
+#include "com/centreon/cdash/digest.hh"
+#include "com/centreon/cdash/xml/node_index.hh"
+#include "com/centreon/cdash/xml/node_iterator.hh"
+
+using namespace com::centreon::cdash::xml;
+
+/**
+ *  Constructor. Index the element children of a node.
+ *
+ *  @param[in] nd  The node.
+ */
+node_index::node_index(node const& nd)
+  : _node(nd) {
+  for (auto const& child : _node)
+    if (child.get_type() == node::element && child.get_name_data())
+      _children[child.get_name_data()].push_back(child);
+}
+
+/**
+ *  Destructor.
+ */
+node_index::~node_index() noexcept {}
+
+/**
+ *  Get the indexed node.
+ *
+ *  @return  The indexed node.
+ */
+node const& node_index::get_node() const noexcept {
+  return (_node);
+}
+
+/**
+ *  Find a subnode.
+ *
+ *  @param[in] name  Name of the subnode.
+ *
+ *  @return          The first subnode of this name, or a null node.
+ */
+node node_index::get_child(char const* name) const noexcept {
+  auto found = _children.find(name);
+  return (found != _children.end() ? found->second.front() : node());
+}
+
+/**
+ *  Find all the subnodes matching a name.
+ *
+ *  @param[in] name  Name of the subnodes.
+ *
+ *  @return          All the subnodes of this name, in document order.
+ */
+std::vector<node> const& node_index::get_children(
+                                       char const* name) const noexcept {
+  static std::vector<node> const none;
+  auto found = _children.find(name);
+  return (found != _children.end() ? found->second : none);
+}
+
+/**
+ *  Hash a name.
+ *
+ *  @param[in] name  The name.
+ *
+ *  @return  The hash of the name.
+ */
+size_t node_index::name_hash::operator()(char const* name) const noexcept {
+  digest dig;
+  dig.update(name, ::strlen(name));
+  return (static_cast<size_t>(dig.get_value()));
+}
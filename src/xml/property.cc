@@ -118,7 +118,27 @@ std::string property::get_name() const {
  *  @return  The content of this property.
  */
 std::string property::get_content() const {
-  return (_prop ?
-            std::string((const char*)(_prop->children->content))
-            : std::string());
+  std::string buffer;
+  char const* content = get_content_data(buffer);
+  return (content == buffer.c_str() ? std::move(buffer) : std::string(content));
+}
+
+/**
+ *  Get the content of this property, without copying it when possible.
+ *
+ *  @param[out] buffer  Holds the content, if it has to be built.
+ *
+ *  @return  The content of this property. It lives as long as the
+ *           document and the buffer.
+ */
+char const* property::get_content_data(std::string& buffer) const {
+  if (!_prop || !_prop->children)
+    return ("");
+  xmlNodePtr child = _prop->children;
+  if (!child->next && child->type == XML_TEXT_NODE && child->content)
+    return ((char const*)(child->content));
+  char* content = (char*)xmlNodeListGetString(_prop->doc, child, 1);
+  buffer = content ? content : "";
+  xmlFree(content);
+  return (buffer.c_str());
 }
@@ -0,0 +1,124 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "com/centreon/cdash/xml/reader.hh"
+#include "com/centreon/exceptions/basic.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash::xml;
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] filename  The file to read.
+ */
+reader::reader(std::string const& filename)
+  : _reader(xmlReaderForFile(filename.c_str(), nullptr, XML_PARSE_NOBLANKS)),
+    _filename(filename),
+    _root_found(false),
+    _on_child(false) {
+}
+
+/**
+ *  Destructor.
+ */
+reader::~reader() noexcept {
+  if (_reader)
+    xmlFreeTextReader(_reader);
+}
+
+/**
+ *  Move constructor.
+ *
+ *  @param[in] rd  Reader to move.
+ */
+reader::reader(reader&& rd)
+  : _reader(rd._reader),
+    _filename(std::move(rd._filename)),
+    _root_found(rd._root_found),
+    _on_child(rd._on_child) {
+  rd._reader = nullptr;
+}
+
+/**
+ *  Move assignment operator.
+ *
+ *  @param[in] rd  Reader to move.
+ *
+ *  @return        Reference to this.
+ */
+reader& reader::operator=(reader&& rd) {
+  if (this != &rd) {
+    if (_reader)
+      xmlFreeTextReader(_reader);
+    _reader = rd._reader;
+    _filename = std::move(rd._filename);
+    _root_found = rd._root_found;
+    _on_child = rd._on_child;
+    rd._reader = nullptr;
+  }
+  return (*this);
+}
+
+/**
+ *  Is this a null reader?
+ *
+ *  @return  True if this is a null reader.
+ */
+bool reader::null() const noexcept {
+  return (!_reader);
+}
+
+/**
+ *  Read the next child of the root node.
+ *
+ *  The previous child is freed.
+ *
+ *  @return  The child, or a null node at the end of the document.
+ */
+node reader::next() {
+  if (!_reader)
+    return (node());
+
+  // Skip the subtree of the previous child.
+  int ret = _on_child ? xmlTextReaderNext(_reader) : xmlTextReaderRead(_reader);
+  _on_child = false;
+  while (ret == 1) {
+    if (xmlTextReaderNodeType(_reader) == XML_READER_TYPE_ELEMENT) {
+      int depth = xmlTextReaderDepth(_reader);
+      if (depth == 0)
+        _root_found = true;
+      else if (depth == 1) {
+        xmlNodePtr nd = xmlTextReaderExpand(_reader);
+        if (!nd)
+          break ;
+        _on_child = true;
+        return (node(nd));
+      }
+    }
+    ret = xmlTextReaderRead(_reader);
+  }
+
+  if (ret != 0)
+    throw (exceptions::basic()
+           << "xml::reader: couldn't parse '" << _filename
+           << "' : invalid xml format");
+  if (!_root_found)
+    throw (exceptions::basic()
+           << "xml::reader: couldn't find the root node of '"
+           << _filename << "'");
+  return (node());
+}
@@ -14,7 +14,9 @@
 ** limitations under the License.
 */
 
+#include <cstring>
 #include <utility>
+#include "com/centreon/cdash/xml/node_index.hh"
 #include "com/centreon/cdash/xml/node_iterator.hh"
 #include "com/centreon/cdash/xml_tree_parser.hh"
 #include "com/centreon/exceptions/basic.hh"
@@ -25,10 +27,10 @@ using namespace com::centreon::cdash;
 /**
  *  Constructor.
  *
- *  @param[in] tree  The tree to parse.
+ *  @param[in] reader  The reader of the objects to parse.
  */
-xml_tree_parser::xml_tree_parser(xml::tree tree)
-  : _tree(std::move(tree)) {}
+xml_tree_parser::xml_tree_parser(xml::reader reader)
+  : _reader(std::move(reader)) {}
 
 /**
  *  Destructor.
@@ -36,7 +38,7 @@ xml_tree_parser::xml_tree_parser(xml::tree tree)
 xml_tree_parser::~xml_tree_parser() noexcept {}
 
 /**
- *  Parse the tree.
+ *  Parse the objects, one at a time.
  *
  *  @param[out] sequences  A list of all the object tasks, in sequential orders.
  *  @param[out] profile    The profile to use, if found.
@@ -44,52 +46,56 @@ xml_tree_parser::~xml_tree_parser() noexcept {}
  */
 void xml_tree_parser::parse(
        std::vector<std::vector<object>>& sequences,
-       std::string& profile) const {
+       std::string& profile) {
   std::map<std::string, object> objects;
-  std::vector<std::vector<std::string>> sequence_list;
-  xml::node root_node = _tree.get_root_node();
+  std::vector<std::vector<object*>> sequence_list;
 
-  if (root_node.null())
-    throw (exceptions::basic()
-           << "xml_tree_parser: couldn't find the root node");
-
-  // For each node.
-  for (auto const& node : root_node) {
+  // For each node. Only the current node is held in memory.
+  for (xml::node node = _reader.next(); !node.null(); node = _reader.next()) {
     // Get profile.
-    if (node.get_name() == "profile") {
-      profile = node.get_content();
+    if (node.has_name("profile")) {
+      std::string content = node.get_content();
+      if (!profile.empty() && profile != content)
+        throw (exceptions::basic()
+               << "xml_tree_parser: conflicting profiles '" << profile
+               << "' and '" << content << "'");
+      profile = std::move(content);
       continue;
     }
 
+    // Index the children once, for all the objects of this node.
+    xml::node_index index(node);
+
     // Get all the objects used in the foreach attributes.
     // This is the external inheritance of this node.
-    std::vector<std::vector<object>> for_each_nodes;
-    for (auto const& for_each_node : node.get_children("foreach")) {
-      std::vector<object> for_each_use_nodes;
+    // Objects are referenced, not copied: the map never moves them.
+    std::vector<std::vector<object const*>> for_each_nodes;
+    for (auto const& for_each_node : index.get_children("foreach")) {
+      std::vector<object const*> for_each_use_nodes;
       for (auto const& for_each_use_node : for_each_node.get_children("use")) {
         auto found_use_node = objects.find(for_each_use_node.get_content());
         if (found_use_node == objects.end())
           throw (exceptions::basic()
                  << "xml_tree_parser: couldn't find node '"
                  << for_each_use_node.get_content() << "'");
-        for_each_use_nodes.push_back(found_use_node->second);
+        for_each_use_nodes.push_back(&found_use_node->second);
       }
       for_each_nodes.push_back(std::move(for_each_use_nodes));
     }
 
     // Get all the objects used in the sequential attribute.
     // This is the sequential inheritances of this node.
-    std::vector<object> sequential_nodes;
-    if (node.get_children("sequential").size() > 1)
+    std::vector<object const*> sequential_nodes;
+    if (index.get_children("sequential").size() > 1)
       throw (exceptions::basic()
              << "xml_tree_parser: more than one sequential attribute for"
-                " node '" << node.get_child("name").get_content() << "'");
-    xml::node seq = node.get_child("sequential");
+                " node '" << index.get_child("name").get_content() << "'");
+    xml::node seq = index.get_child("sequential");
     if (!seq.null()) {
-      if (node.get_name() != "task")
+      if (!node.has_name("task"))
         throw (exceptions::basic()
                << "xml_tree_parser: sequential attribute in a non-task object"
-                  " '" << node.get_child("name").get_content()) << "'";
+                  " '" << index.get_child("name").get_content()) << "'";
       for (auto const& sequential_node_uses : seq.get_children("use")) {
         auto found_sequential_node
           = objects.find(sequential_node_uses.get_content());
@@ -97,20 +103,17 @@ void xml_tree_parser::parse(
           throw (exceptions::basic()
                  << "xml_tree_parser: couldn't find node '"
                  << sequential_node_uses.get_content() << "'");
-        sequential_nodes.push_back(found_sequential_node->second);
+        sequential_nodes.push_back(&found_sequential_node->second);
       }
     }
 
     // Create an object for all the cartesian products
     // of the external inheritances and sequential inheritances.
     // We retrieve the sequence of objects and store it into a list.
-    std::vector<object> uses;
     _for_each_node(
-      for_each_nodes.begin(),
-      for_each_nodes.end(),
+      for_each_nodes,
       sequential_nodes,
-      node,
-      uses,
+      index,
       objects,
       sequence_list);
   }
@@ -119,11 +122,11 @@ void xml_tree_parser::parse(
   // If the first object of the sequence is a task,
   // store the sequence's objects for the caller.
   for (auto const& sequence : sequence_list) {
-    object const& obj = objects.at(sequence.front());
-    if (obj.get_type() == "task") {
+    if (sequence.front()->get_type() == "task") {
       std::vector<object> object_sequence;
-      for (std::string const& object_name : sequence)
-        object_sequence.emplace_back(std::move(objects.at(object_name)));
+      object_sequence.reserve(sequence.size());
+      for (object* obj : sequence)
+        object_sequence.emplace_back(std::move(*obj));
       sequences.emplace_back(std::move(object_sequence));
     }
   }
@@ -132,25 +135,25 @@ void xml_tree_parser::parse(
 /**
  *  Parse an instance of a node.
  *
- *  @param[in] node         The node.
+ *  @param[in] node         The node, with its children indexed.
  *  @param[in] use          The external inheritance of this node.
  *  @param[in,out] objects  The object map.
  *
- *  @return                 The unique name of this node.
+ *  @return                 The object created for this node.
  */
-std::string xml_tree_parser::_parse_node(
-              xml::node node,
-              std::vector<object> const& use,
-              std::map<std::string, object> &objects) const {
+object* xml_tree_parser::_parse_node(
+          xml::node_index const& node,
+          std::vector<object const*> const& use,
+          std::map<std::string, object> &objects) const {
   // Get type.
-  std::string type = node.get_name();
+  std::string type = node.get_node().get_name();
 
   // Create object.
   object obj(type);
 
   // Inherit the external objects.
-  for (auto const& dep : use)
-    obj.inherit_macros(dep);
+  for (object const* dep : use)
+    obj.inherit_macros(*dep);
 
   // Resolve internal dependencies.
   for (auto const& dep : node.get_children("use")) {
@@ -159,6 +162,22 @@ std::string xml_tree_parser::_parse_node(
       obj.inherit_macros(found->second);
   }
 
+  // Set macros. They are resolved on use, when all of them are known.
+  // Names and contents are interned from the document, not copied.
+  std::string buffer;
+  for (auto const& sub_node : node.get_node()) {
+    if (!sub_node.has_name("name")
+        && !sub_node.has_name("use")
+        && !sub_node.has_name("file")
+        && !sub_node.has_name("returned_file")) {
+      char const* name = sub_node.get_name_data();
+      char const* content = sub_node.get_content_data(buffer);
+      obj.set_macro(
+            symbol_table::intern(name, ::strlen(name)),
+            symbol_table::intern(content, ::strlen(content)));
+    }
+  }
+
   // Get and resolve name.
   std::string name = node.get_child("name").get_content();
   if (name.empty())
@@ -167,34 +186,28 @@ std::string xml_tree_parser::_parse_node(
   name = obj.resolve_macros(std::move(name));
   obj.set_name(name);
 
-  // Set macros.
-  for (auto const& sub_node : node) {
-    if (sub_node.get_name() != "name"
-        && sub_node.get_name() != "use") {
-      if (sub_node.get_name() != "file" && sub_node.get_name() != "returned_file")
-        obj.set_macro(
-              sub_node.get_name(),
-              obj.resolve_macros(sub_node.get_content()));
-      else {
-        std::string local_filename = sub_node.get_child("in").get_content();
-        std::string remote_filename = sub_node.get_child("out").get_content();
-        bool resolve_macro =
-            (sub_node.get_child("resolve_macro").get_content() == "true");
+  // Add files.
+  for (auto const& sub_node : node.get_node()) {
+    bool is_file = sub_node.has_name("file");
+    if (is_file || sub_node.has_name("returned_file")) {
+      std::string local_filename = sub_node.get_child("in").get_content();
+      std::string remote_filename = sub_node.get_child("out").get_content();
+      bool resolve_macro =
+          (sub_node.get_child("resolve_macro").get_content() == "true");
 
-        if (local_filename.empty() || remote_filename.empty())
-          throw (exceptions::basic()
-                 << "xml_tree_parser: couldn't find local filename or "
-                    "remote filename for '" << name << "'");
-        if (sub_node.get_name() == "file")
-          obj.add_file(
-                obj.resolve_macros(local_filename),
-                obj.resolve_macros(remote_filename),
-                resolve_macro);
-        else if (sub_node.get_name() == "returned_file")
-          obj.add_returned_file(
-                 obj.resolve_macros(local_filename),
-                 obj.resolve_macros(remote_filename));
-      }
+      if (local_filename.empty() || remote_filename.empty())
+        throw (exceptions::basic()
+               << "xml_tree_parser: couldn't find local filename or "
+                  "remote filename for '" << name << "'");
+      if (is_file)
+        obj.add_file(
+              obj.resolve_macros(local_filename),
+              obj.resolve_macros(remote_filename),
+              resolve_macro);
+      else
+        obj.add_returned_file(
+               obj.resolve_macros(local_filename),
+               obj.resolve_macros(remote_filename));
     }
   }
 
@@ -205,58 +218,61 @@ std::string xml_tree_parser::_parse_node(
     throw (exceptions::basic()
            << "xml_tree_parser: object '" << name << "' already exists");
 
-  return (std::move(name));
+  return (&inserted.first->second);
 }
 
 /**
- *  Used to recurse upon all the foreach and
- *  create an object for all cartesian combination.
+ *  Create an object for all the cartesian combinations of the foreach
+ *  entries of a node.
  *
- *  @param[in] here          Used by the recursion.
- *  @param[in] end           Used by the recursion.
- *  @param[in] seq_entries   The sequential entries of this objects.
- *  @param[in] node          The xml node of the object.
- *  @param[in] use           List of external node inheritance built
- *                           by the recursion.
- *  @param[int,out] objects  Object map
- *  @param[out] sequence_list List of all sequential objects that is
- *                            constituting a sequential task.
+ *  Combinations are generated one at a time, like an odometer whose
+ *  last wheel turns the fastest.
+ *
+ *  @param[in] for_each_entries  The foreach entries of this object.
+ *  @param[in] seq_entries       The sequential entries of this object.
+ *  @param[in] node              The xml node of the object, indexed.
+ *  @param[in,out] objects       Object map
+ *  @param[out] sequence_list    List of all sequential objects that is
+ *                               constituting a sequential task.
  */
 void  xml_tree_parser::_for_each_node(
-        std::vector<std::vector<object>>::const_iterator here,
-        std::vector<std::vector<object>>::const_iterator end,
-        std::vector<object> const& seq_entries,
-        xml::node node,
-        std::vector<object>& use,
+        std::vector<std::vector<object const*>> const& for_each_entries,
+        std::vector<object const*> const& seq_entries,
+        xml::node_index const& node,
         std::map<std::string, object> &objects,
-        std::vector<std::vector<std::string>>& sequence_list) const {
-  if (here == end) {
-    // Now that we have all the foreach combinations for this node,
-    // we create an object for each sequential entry. If no sequential entry
-    // was given, we create only one object.
-    std::vector<std::string> sequence;
+        std::vector<std::vector<object*>>& sequence_list) const {
+  // A foreach without entries has no combination.
+  for (auto const& entries : for_each_entries)
+    if (entries.empty())
+      return ;
+
+  std::vector<size_t> wheels(for_each_entries.size(), 0);
+  std::vector<object const*> use(for_each_entries.size());
+  bool more = true;
+  while (more) {
+    for (size_t i = 0; i < wheels.size(); ++i)
+      use[i] = for_each_entries[i][wheels[i]];
+
+    // We create an object for each sequential entry of this combination.
+    // If no sequential entry was given, we create only one object.
+    std::vector<object*> sequence;
     if (seq_entries.size() == 0)
-      sequence.emplace_back(_parse_node(node, use, objects));
+      sequence.push_back(_parse_node(node, use, objects));
     else
-      for (auto const& seq_entry : seq_entries) {
-       use.push_back(seq_entry);
-       sequence.emplace_back(_parse_node(node, use, objects));
-       use.pop_back();
+      for (object const* seq_entry : seq_entries) {
+        use.push_back(seq_entry);
+        sequence.push_back(_parse_node(node, use, objects));
+        use.pop_back();
       }
     sequence_list.emplace_back(std::move(sequence));
-  }
-  else {
-    for (auto const& n : *here) {
-      use.push_back(n);
-      _for_each_node(
-        here + 1,
-        end,
-        seq_entries,
-        node,
-        use,
-        objects,
-        sequence_list);
-      use.pop_back();
+
+    // Next combination.
+    size_t i = wheels.size();
+    for (; i > 0; --i) {
+      if (++wheels[i - 1] < for_each_entries[i - 1].size())
+        break ;
+      wheels[i - 1] = 0;
     }
+    more = (i > 0);
   }
 }
@@ -0,0 +1,211 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "com/centreon/cdash/config_cache.hh"
+#include "com/centreon/cdash/object.hh"
+#include "com/centreon/cdash/sequence.hh"
+#include "com/centreon/cdash/task.hh"
+
+using namespace com::centreon::cdash;
+
+/**
+ *  Write a file.
+ *
+ *  @param[in] path     The file.
+ *  @param[in] content  Its content.
+ */
+static void write_file(std::string const& path, std::string const& content) {
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd != -1) {
+    if (::write(fd, content.data(), content.size()) < 0)
+      std::cerr << "couldn't write '" << path << "'" << std::endl;
+    ::close(fd);
+  }
+}
+
+/**
+ *  Read a file.
+ *
+ *  @param[in] path  The file.
+ *
+ *  @return  Its content.
+ */
+static std::string read_file(std::string const& path) {
+  std::string content;
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd != -1) {
+    char buffer[4096];
+    ssize_t rb;
+    while ((rb = ::read(fd, buffer, sizeof(buffer))) > 0)
+      content.append(buffer, rb);
+    ::close(fd);
+  }
+  return (content);
+}
+
+/**
+ *  Save a sequence of one task in the cache of the files.
+ *
+ *  @param[in] filenames  The configuration files.
+ *  @param[in] resolved   A file whose macros are resolved.
+ */
+static void save(
+              std::vector<std::string> const& filenames,
+              std::string const& resolved) {
+  object obj("task");
+  obj.set_name("build");
+  obj.set_macro("ami", "ami-1");
+  obj.set_macro("command", "make $target$");
+  obj.set_macro("target", "all");
+  obj.set_macro("type", "t2.micro");
+  obj.set_macro("key", "key");
+  obj.set_macro("security_group", "default");
+  obj.add_file(resolved, "remote", true);
+  std::vector<sequence> sequences(1);
+  sequences.back().add_task(task(std::move(obj)));
+
+  config_cache cache(filenames);
+  std::vector<std::vector<object>> objects;
+  std::string profile;
+  // The key is computed by load().
+  cache.load(objects, profile);
+  cache.save(sequences, "profile");
+}
+
+/**
+ *  Load the cache of the files.
+ *
+ *  @param[in]  filenames  The configuration files.
+ *  @param[out] objects    The objects of the sequences.
+ *
+ *  @return  True if the cache was valid.
+ */
+static bool load(
+              std::vector<std::string> const& filenames,
+              std::vector<std::vector<object>>& objects) {
+  config_cache cache(filenames);
+  std::string profile;
+  bool loaded = cache.load(objects, profile);
+  if (loaded && profile != "profile") {
+    std::cerr << "profile '" << profile << "' loaded" << std::endl;
+    loaded = false;
+  }
+  return (loaded);
+}
+
+/**
+ *  Check that the cache is kept by set of configuration files, and
+ *  is only used while the configuration files and the files whose
+ *  macros are resolved don't change.
+ *
+ *  @return EXIT_SUCCESS on success.
+ */
+int main() {
+  int retval = EXIT_FAILURE;
+  char dir[] = "/tmp/cdash-test-XXXXXX";
+  if (!::mkdtemp(dir)) {
+    std::cerr << "couldn't create the test directory" << std::endl;
+    return (retval);
+  }
+  std::string directory(dir);
+  ::setenv("XDG_CACHE_HOME", dir, 1);
+  std::string first(directory + "/first.xml");
+  std::string second(directory + "/second.xml");
+  std::string resolved(directory + "/resolved.txt");
+  write_file(first, "<cdash></cdash>\n");
+  write_file(second, "<cdash></cdash>\n");
+  write_file(resolved, "make $target$\n");
+  std::vector<std::string> both;
+  both.push_back(first);
+  both.push_back(second);
+  std::vector<std::string> only_first(1, first);
+
+  std::string path;
+  try {
+    bool ok = true;
+    // One cache for each set of files.
+    path = config_cache(both).get_path();
+    if (path.compare(0, directory.size() + 7, directory + "/cdash/") != 0
+        || path == config_cache(only_first).get_path()
+        || path != config_cache(both).get_path()) {
+      std::cerr << "invalid cache path '" << path << "'" << std::endl;
+      ok = false;
+    }
+
+    std::vector<std::vector<object>> objects;
+    if (load(both, objects)) {
+      std::cerr << "cache loaded before being saved" << std::endl;
+      ok = false;
+    }
+    save(both, resolved);
+    objects.clear();
+    if (!load(both, objects)) {
+      std::cerr << "saved cache not loaded" << std::endl;
+      ok = false;
+    }
+    else if (objects.size() != 1 || objects[0].size() != 1
+             || objects[0][0].get_name() != "build"
+             || objects[0][0].macro_content("command") != "make all"
+             || objects[0][0].get_files().size() != 1
+             || read_file(objects[0][0].get_files()[0].get_temporary_file())
+                  != "make all\n") {
+      std::cerr << "invalid objects loaded" << std::endl;
+      ok = false;
+    }
+    objects.clear();
+    if (load(only_first, objects)) {
+      std::cerr << "cache of other files loaded" << std::endl;
+      ok = false;
+    }
+
+    // A file whose macros are resolved changes.
+    write_file(resolved, "make $target$ install\n");
+    objects.clear();
+    if (load(both, objects)) {
+      std::cerr << "cache loaded after a resolved file changed"
+                << std::endl;
+      ok = false;
+    }
+
+    // A configuration file changes.
+    save(both, resolved);
+    write_file(second, "<cdash> </cdash>\n");
+    objects.clear();
+    if (load(both, objects)) {
+      std::cerr << "cache loaded after a configuration file changed"
+                << std::endl;
+      ok = false;
+    }
+    if (ok)
+      retval = EXIT_SUCCESS;
+  } catch (std::exception const& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+  }
+  ::unlink(path.c_str());
+  ::unlink(first.c_str());
+  ::unlink(second.c_str());
+  ::unlink(resolved.c_str());
+  ::rmdir((directory + "/cdash").c_str());
+  ::rmdir(directory.c_str());
+  return (retval);
+}
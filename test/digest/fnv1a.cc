@@ -0,0 +1,109 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "com/centreon/cdash/digest.hh"
+
+using namespace com::centreon::cdash;
+
+/**
+ *  Get the digest of raw data.
+ *
+ *  @param[in] data  The data.
+ *
+ *  @return  The digest.
+ */
+static unsigned long long raw_digest(std::string const& data) {
+  digest dig;
+  dig.update(data.data(), data.size());
+  return (dig.get_value());
+}
+
+/**
+ *  Check the FNV-1a digest of data, strings and files.
+ *
+ *  @return EXIT_SUCCESS on success.
+ */
+int main() {
+  int retval = EXIT_FAILURE;
+  try {
+    bool ok = true;
+    // Reference values of 64 bits FNV-1a.
+    if (raw_digest("") != 0xcbf29ce484222325ull
+        || raw_digest("a") != 0xaf63dc4c8601ec8cull
+        || raw_digest("foobar") != 0x85944171f73967e8ull) {
+      std::cerr << "invalid FNV-1a values" << std::endl;
+      ok = false;
+    }
+    if (digest().to_string() != "cbf29ce484222325") {
+      std::cerr << "invalid string '" << digest().to_string() << "'"
+                << std::endl;
+      ok = false;
+    }
+
+    // Data can be digested by pieces.
+    digest pieces;
+    pieces.update("foo", 3);
+    pieces.update("bar", 3);
+    if (pieces.get_value() != raw_digest("foobar")) {
+      std::cerr << "digest by pieces differs" << std::endl;
+      ok = false;
+    }
+
+    // Strings are delimited: 'ab' + 'c' differs from 'a' + 'bc'.
+    digest first;
+    first.update(std::string("ab"));
+    first.update(std::string("c"));
+    digest second;
+    second.update(std::string("a"));
+    second.update(std::string("bc"));
+    if (first.get_value() == second.get_value()) {
+      std::cerr << "strings aren't delimited" << std::endl;
+      ok = false;
+    }
+
+    // Files are digested as their content.
+    char path[] = "/tmp/cdash-test-XXXXXX";
+    int fd = ::mkstemp(path);
+    if (fd == -1) {
+      std::cerr << "couldn't create the test file" << std::endl;
+      ok = false;
+    }
+    else {
+      std::string content(100000, 'x');
+      if (::write(fd, content.data(), content.size()) < 0)
+        ok = false;
+      ::close(fd);
+      digest file;
+      file.update_file(path);
+      ::unlink(path);
+      if (file.get_value() != raw_digest(content)) {
+        std::cerr << "digest of the file differs" << std::endl;
+        ok = false;
+      }
+    }
+    if (ok)
+      retval = EXIT_SUCCESS;
+  } catch (std::exception const& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+  }
+  return (retval);
+}
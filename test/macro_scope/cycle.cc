@@ -0,0 +1,86 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "com/centreon/cdash/object.hh"
+
+using namespace com::centreon::cdash;
+
+/**
+ *  Check that resolving a macro fails.
+ *
+ *  @param[in] obj   The object.
+ *  @param[in] name  The name of the macro.
+ *
+ *  @return  True if it failed.
+ */
+static bool fails(object const& obj, std::string const& name) {
+  try {
+    obj.resolve_macros("$" + name + "$");
+  } catch (std::exception const& e) {
+    return (true);
+  }
+  std::cerr << "macro '" << name << "' resolved despite its cycle"
+            << std::endl;
+  return (false);
+}
+
+/**
+ *  Check that macros depending on themselves are detected, and that
+ *  other macros still resolve.
+ *
+ *  @return EXIT_SUCCESS on success.
+ */
+int main() {
+  int retval = EXIT_FAILURE;
+  try {
+    object obj("task");
+    obj.set_name("cycle");
+    obj.set_macro("a", "$b$");
+    obj.set_macro("b", "$a$");
+    obj.set_macro("x", "$y$-");
+    obj.set_macro("y", "$z$-");
+    obj.set_macro("z", "$x$-");
+    obj.set_macro("user", "[$a$]");
+    obj.set_macro("fine", "$ok$ $ok$");
+    obj.set_macro("ok", "yes");
+
+    bool ok = fails(obj, "a") && fails(obj, "b");
+    ok = fails(obj, "x") && ok;
+    ok = fails(obj, "user") && ok;
+    // Twice the same macro isn't a cycle.
+    std::string fine = obj.resolve_macros("$fine$");
+    if (fine != "yes yes") {
+      std::cerr << "macro 'fine' resolved to '" << fine << "'" << std::endl;
+      ok = false;
+    }
+    // Unknown macros are empty.
+    std::string unknown = obj.resolve_macros("<$unknown$>");
+    if (unknown != "<>") {
+      std::cerr << "unknown macro resolved to '" << unknown << "'"
+                << std::endl;
+      ok = false;
+    }
+    if (ok)
+      retval = EXIT_SUCCESS;
+  } catch (std::exception const& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+  }
+  return (retval);
+}
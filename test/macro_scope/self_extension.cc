@@ -0,0 +1,87 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "com/centreon/cdash/object.hh"
+
+using namespace com::centreon::cdash;
+
+/**
+ *  Check the resolution of a string.
+ *
+ *  @param[in] obj       The object.
+ *  @param[in] str       The string.
+ *  @param[in] expected  Its expected resolution.
+ *
+ *  @return  True if it matches.
+ */
+static bool check(
+              object const& obj,
+              std::string const& str,
+              std::string const& expected) {
+  std::string resolved = obj.resolve_macros(str);
+  if (resolved != expected) {
+    std::cerr << "'" << str << "' of '" << obj.get_name()
+              << "' resolved to '" << resolved << "' instead of '"
+              << expected << "'" << std::endl;
+    return (false);
+  }
+  return (true);
+}
+
+/**
+ *  Check that a macro using its own name extends the macro of this
+ *  name inherited from its parents.
+ *
+ *  @return EXIT_SUCCESS on success.
+ */
+int main() {
+  int retval = EXIT_FAILURE;
+  try {
+    object base("base");
+    base.set_name("base");
+    base.set_macro("flags", "-Wall");
+    object compiler("compiler");
+    compiler.set_name("gcc");
+    compiler.inherit_macros(base);
+    compiler.set_macro("flags", "$flags$ -g");
+    object tsk("task");
+    tsk.set_name("build");
+    tsk.inherit_macros(compiler);
+    tsk.set_macro("flags", "$flags$ -O2");
+    tsk.set_macro("command", "make CFLAGS='$flags$'");
+    tsk.set_macro("parent_flags", "$compiler.flags$");
+    tsk.set_macro("alone", "$alone$!");
+
+    bool ok = check(tsk, "$flags$", "-Wall -g -O2");
+    // Other macros see the extended macro.
+    ok = check(tsk, "$command$", "make CFLAGS='-Wall -g -O2'") && ok;
+    // Parents are left as is.
+    ok = check(compiler, "$flags$", "-Wall -g") && ok;
+    ok = check(base, "$flags$", "-Wall") && ok;
+    ok = check(tsk, "$parent_flags$", "-Wall -g") && ok;
+    // Nothing inherited: the macro is empty.
+    ok = check(tsk, "$alone$", "!") && ok;
+    if (ok)
+      retval = EXIT_SUCCESS;
+  } catch (std::exception const& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+  }
+  return (retval);
+}
@@ -0,0 +1,144 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "com/centreon/process.hh"
+#include "com/centreon/process_manager.hh"
+#include "com/centreon/cdash/tar_reader.hh"
+#include "com/centreon/cdash/tar_writer.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+// Just above the biggest size written in octal.
+static unsigned long long const big_size = 077777777777ull + 4;
+
+/**
+ *  Signal handler: writes to the exited archive process fail instead.
+ */
+static void ignore(int) {}
+
+/**
+ *  Write the header of a big sparse file with tar_writer, and return it.
+ *
+ *  @param[in] directory  Where to create the files.
+ *
+ *  @return  The header, empty on error.
+ */
+static std::string write_header(std::string const& directory) {
+  std::string big(directory + "/big");
+  std::string header_file(directory + "/header");
+  int fd = ::open(big.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1 || ::ftruncate(fd, big_size) != 0) {
+    std::cerr << "couldn't create '" << big << "'" << std::endl;
+    if (fd != -1)
+      ::close(fd);
+    return (std::string());
+  }
+  ::close(fd);
+
+  // The archive process keeps the header only, then exits.
+  process proc;
+  proc.enable_stream(process::in, true);
+  proc.exec(
+         "dd of=" + header_file
+         + " bs=512 count=1 iflag=fullblock status=none");
+  tar_writer writer(proc);
+  try {
+    writer.add_file("big", big, 0644);
+  } catch (std::exception const& e) {
+    // Expected: the archive process exited.
+  }
+  proc.enable_stream(process::in, false);
+  proc.wait();
+  ::unlink(big.c_str());
+
+  std::string header;
+  fd = ::open(header_file.c_str(), O_RDONLY);
+  if (fd != -1) {
+    char buffer[512];
+    if (::read(fd, buffer, sizeof(buffer)) == sizeof(buffer))
+      header.assign(buffer, sizeof(buffer));
+    ::close(fd);
+    ::unlink(header_file.c_str());
+  }
+  return (header);
+}
+
+/**
+ *  Check that sizes of 8 GiB or more are written in base-256 and read
+ *  back.
+ *
+ *  @return EXIT_SUCCESS on success.
+ */
+int main() {
+  int retval = EXIT_FAILURE;
+  process_manager::load();
+  struct sigaction sig;
+  ::memset(&sig, 0, sizeof(sig));
+  sig.sa_handler = ignore;
+  ::sigaction(SIGPIPE, &sig, nullptr);
+
+  char directory[] = "/tmp/cdash-test-XXXXXX";
+  if (!::mkdtemp(directory))
+    std::cerr << "couldn't create the test directory" << std::endl;
+  else {
+    try {
+      std::string header = write_header(directory);
+      unsigned long long size = 0;
+      for (int i = 125; i < 136 && !header.empty(); ++i)
+        size = (size << 8) | static_cast<unsigned char>(header[i]);
+      if (header.empty())
+        std::cerr << "no header written" << std::endl;
+      else if (static_cast<unsigned char>(header[124]) != 0x80
+               || size != big_size)
+        std::cerr << "size not written in base-256: " << size << std::endl;
+      else {
+        // Read the whole entry back, its content discarded.
+        tar_reader reader;
+        reader.add_file("big", "/dev/null");
+        reader.feed(header.data(), header.size());
+        std::vector<char> zero(1024 * 1024, 0);
+        for (unsigned long long left = big_size; left > 0;) {
+          size_t len = left < zero.size() ? left : zero.size();
+          reader.feed(zero.data(), len);
+          left -= len;
+        }
+        // Padding and end of archive.
+        reader.feed(zero.data(), (512 - big_size % 512) % 512 + 1024);
+        reader.finish();
+        auto found = reader.get_extracted_files().find("big");
+        if (found == reader.get_extracted_files().end()
+            || found->second != big_size)
+          std::cerr << "size not read back from base-256" << std::endl;
+        else
+          retval = EXIT_SUCCESS;
+      }
+    } catch (std::exception const& e) {
+      std::cerr << "error: " << e.what() << std::endl;
+    }
+    ::rmdir(directory);
+  }
+  process_manager::unload();
+  return (retval);
+}
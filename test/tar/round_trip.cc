@@ -0,0 +1,182 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include "com/centreon/process.hh"
+#include "com/centreon/process_manager.hh"
+#include "com/centreon/cdash/tar_reader.hh"
+#include "com/centreon/cdash/tar_writer.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::cdash;
+
+/**
+ *  Write a file.
+ *
+ *  @param[in] path     The file.
+ *  @param[in] content  Its content.
+ */
+static void write_file(std::string const& path, std::string const& content) {
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd != -1) {
+    if (::write(fd, content.data(), content.size()) < 0)
+      std::cerr << "couldn't write '" << path << "'" << std::endl;
+    ::close(fd);
+  }
+}
+
+/**
+ *  Read a file.
+ *
+ *  @param[in] path  The file.
+ *
+ *  @return  Its content.
+ */
+static std::string read_file(std::string const& path) {
+  std::string content;
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd != -1) {
+    char buffer[4096];
+    ssize_t rb;
+    while ((rb = ::read(fd, buffer, sizeof(buffer))) > 0)
+      content.append(buffer, rb);
+    ::close(fd);
+  }
+  return (content);
+}
+
+/**
+ *  Check that the files written by tar_writer are extracted by
+ *  tar_reader, whatever the chunks the archive is fed by.
+ *
+ *  @return EXIT_SUCCESS on success.
+ */
+int main() {
+  int retval = EXIT_FAILURE;
+  process_manager::load();
+  char dir[] = "/tmp/cdash-test-XXXXXX";
+  if (!::mkdtemp(dir)) {
+    std::cerr << "couldn't create the test directory" << std::endl;
+    return (retval);
+  }
+  std::string directory(dir);
+
+  // Entry names and contents: empty, small, one block, and a long name
+  // with a content of several blocks.
+  std::map<std::string, std::string> files;
+  files["empty"] = "";
+  files["small"] = "hello\n";
+  files["block"] = std::string(512, 'b');
+  std::string long_content;
+  for (int i = 0; long_content.size() < 70000; ++i)
+    long_content.append(std::to_string(i)).append(1, '\n');
+  files[std::string(150, 'l') + "/name"] = long_content;
+
+  std::string archive(directory + "/archive.tar");
+  try {
+    int index = 0;
+    std::map<std::string, std::string> sources;
+    for (auto const& f : files) {
+      std::string source(directory + "/source-" + std::to_string(index++));
+      write_file(source, f.second);
+      sources[f.first] = source;
+    }
+
+    process proc;
+    proc.enable_stream(process::in, true);
+    proc.exec("dd of=" + archive + " status=none");
+    tar_writer writer(proc);
+    for (auto const& s : sources)
+      writer.add_file(s.first, s.second, 0640);
+    writer.finish();
+    proc.enable_stream(process::in, false);
+    proc.wait();
+    for (auto const& s : sources)
+      ::unlink(s.second.c_str());
+
+    std::string content = read_file(archive);
+    if (content.size() != writer.get_size()
+        || content.size() % 512 != 0)
+      std::cerr << "invalid archive size " << content.size() << std::endl;
+    else {
+      bool ok = true;
+      // Odd chunk sizes cut the headers and the contents anywhere.
+      size_t const chunk_sizes[] = { 1, 77, 512, 4096, content.size() };
+      for (size_t chunk_size : chunk_sizes) {
+        tar_reader reader;
+        index = 0;
+        std::map<std::string, std::string> extracted;
+        for (auto const& f : files) {
+          std::string path(
+                        directory + "/extracted-" + std::to_string(index++));
+          reader.add_file(f.first, path);
+          extracted[f.first] = path;
+        }
+        for (size_t pos = 0; pos < content.size(); pos += chunk_size)
+          reader.feed(
+                   content.data() + pos,
+                   std::min(chunk_size, content.size() - pos));
+        reader.finish();
+        for (auto const& f : files) {
+          auto size = reader.get_extracted_files().find(f.first);
+          if (size == reader.get_extracted_files().end()
+              || size->second != f.second.size()
+              || read_file(extracted[f.first]) != f.second) {
+            std::cerr << "file '" << f.first << "' not extracted with "
+                      << chunk_size << " bytes chunks" << std::endl;
+            ok = false;
+          }
+          ::unlink(extracted[f.first].c_str());
+        }
+      }
+
+      // A truncated archive is an error.
+      try {
+        tar_reader reader;
+        reader.feed(content.data(), 1000);
+        reader.finish();
+        std::cerr << "truncated archive not detected" << std::endl;
+        ok = false;
+      } catch (std::exception const& e) {}
+
+      // So is a missing file.
+      try {
+        tar_reader reader;
+        reader.add_file("missing", directory + "/missing");
+        reader.feed(content.data(), content.size());
+        reader.finish();
+        std::cerr << "missing file not detected" << std::endl;
+        ok = false;
+      } catch (std::exception const& e) {}
+
+      if (ok)
+        retval = EXIT_SUCCESS;
+    }
+  } catch (std::exception const& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+  }
+  ::unlink(archive.c_str());
+  ::rmdir(directory.c_str());
+  process_manager::unload();
+  return (retval);
+}
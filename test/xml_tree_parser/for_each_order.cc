@@ -0,0 +1,106 @@
+/*
+** Copyright 2015-2016 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**    http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "com/centreon/cdash/config_file.hh"
+#include "com/centreon/cdash/xml/library.hh"
+
+using namespace com::centreon::cdash;
+
+// Two foreach clauses, and a sequential clause.
+static char const* const configuration =
+  "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+  "<cdash>\n"
+  "  <machine><name>m1</name></machine>\n"
+  "  <machine><name>m2</name></machine>\n"
+  "  <project><name>p1</name></project>\n"
+  "  <project><name>p2</name></project>\n"
+  "  <project><name>p3</name></project>\n"
+  "  <step><name>s1</name></step>\n"
+  "  <step><name>s2</name></step>\n"
+  "  <task>\n"
+  "    <name>$machine.name$-$project.name$-$step.name$</name>\n"
+  "    <foreach><use>m1</use><use>m2</use></foreach>\n"
+  "    <foreach><use>p1</use><use>p2</use><use>p3</use></foreach>\n"
+  "    <sequential><use>s1</use><use>s2</use></sequential>\n"
+  "  </task>\n"
+  "</cdash>\n";
+
+/**
+ *  Check that the combinations of foreach clauses are created in
+ *  order, the last clause changing the fastest, with a sequence for
+ *  each combination.
+ *
+ *  @return EXIT_SUCCESS on success.
+ */
+int main() {
+  int retval = EXIT_FAILURE;
+  char path[] = "/tmp/cdash-test-XXXXXX";
+  int fd = ::mkstemp(path);
+  if (fd == -1) {
+    std::cerr << "couldn't create the test file" << std::endl;
+    return (retval);
+  }
+  std::string content(configuration);
+  bool written = (::write(fd, content.data(), content.size())
+                  == static_cast<ssize_t>(content.size()));
+  ::close(fd);
+
+  try {
+    xml::library _;
+    config_file cfg(path);
+    cfg.run();
+    std::vector<std::vector<object>>& sequences = cfg.get_sequences();
+    std::vector<std::string> names;
+    for (auto const& seq : sequences)
+      for (auto const& obj : seq)
+        names.push_back(obj.get_name());
+
+    std::vector<std::string> expected;
+    char const* const machines[] = { "m1", "m2" };
+    char const* const projects[] = { "p1", "p2", "p3" };
+    for (auto m : machines)
+      for (auto p : projects) {
+        expected.push_back(std::string(m) + "-" + p + "-s1");
+        expected.push_back(std::string(m) + "-" + p + "-s2");
+      }
+
+    if (!written || !cfg.get_error().empty())
+      std::cerr << "couldn't parse the configuration: "
+                << cfg.get_error() << std::endl;
+    else if (sequences.size() != 6)
+      std::cerr << sequences.size() << " sequences instead of 6"
+                << std::endl;
+    else if (names != expected) {
+      std::cerr << "combinations in the wrong order:";
+      for (auto const& name : names)
+        std::cerr << " " << name;
+      std::cerr << std::endl;
+    }
+    else
+      retval = EXIT_SUCCESS;
+  } catch (std::exception const& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+  }
+  ::unlink(path);
+  return (retval);
+}